@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Большие плотные массивы (матрицы, сетки) на анонимных отображениях
+// вместо malloc. Даёт три вещи:
+//
+//   - выравнивание начала массива на alignment байт (по умолчанию 64 —
+//     строка кэша и вектор AVX-512);
+//   - подложку страницами 2 МБ: Transparent — madvise(MADV_HUGEPAGE) на
+//     участке, выровненном на 2 МБ (работает при THP в режиме madvise или
+//     always), HugeTlb — MAP_HUGETLB из заранее выделенного пула
+//     (vm.nr_hugepages), при неудаче — откат на Transparent. Small явно
+//     запрещает THP (MADV_NOHUGEPAGE), чтобы сравнивать с 4 КБ честно;
+//   - политику NUMA через mbind до первого касания, без libnuma. Ошибка
+//     mbind не фатальна: массив остаётся с политикой по умолчанию.
+//
+// Массивы, выровненные одинаково на 2 МБ, совпадают младшими 21 битом
+// адреса: A[k] и Anew[k] шаблона попадают в одни наборы L1/L2 и в
+// 4K-aliasing, и Якоби 1024x1024 на THP шёл почти вдвое медленнее, чем
+// на 4 КБ. Поэтому начало каждого массива сдвигается на stagger_offset():
+// по кругу 0..7 раз по 17 выравниваний (17 * 64 = 1088 байт).
+//
+// Память обнуляется ядром. Фактическая подложка видна через pages(); для
+// Transparent ядро может не найти свободных 2 МБ, это показывает huge_bytes().
+
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+enum class Pages { Small, Transparent, HugeTlb };
+
+enum class NumaPolicy { None, Bind, Interleave };
+
+struct AllocationOptions {
+    size_t alignment = 64;
+    bool stagger = true;
+    Pages pages = Pages::Transparent;
+    NumaPolicy numa = NumaPolicy::None;
+    int node = 0;
+};
+
+inline Pages parse_pages(const std::string& name)
+{
+    if (name == "4k")
+        return Pages::Small;
+    if (name == "thp")
+        return Pages::Transparent;
+    if (name == "hugetlb")
+        return Pages::HugeTlb;
+    throw std::runtime_error("неизвестный вид страниц: " + name + " (4k | thp | hugetlb)");
+}
+
+inline const char* pages_name(Pages pages)
+{
+    switch (pages)
+    {
+    case Pages::Small:
+        return "4k";
+    case Pages::Transparent:
+        return "thp";
+    default:
+        return "hugetlb";
+    }
+}
+
+// Маска узлов из /sys/devices/system/node/online ("0", "0-3", "0,2-3").
+inline unsigned long online_numa_nodes()
+{
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    if (!std::getline(file, list))
+        return 1;
+    unsigned long mask = 0;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        const size_t dash = item.find('-');
+        const int first = std::stoi(item.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for (int node = first; node <= last && node < 64; ++node)
+            mask |= 1UL << node;
+    }
+    return mask ? mask : 1;
+}
+
+inline bool apply_numa_policy(void* addr, size_t bytes, NumaPolicy policy, int node)
+{
+#if defined(SYS_mbind)
+    // Значения MPOL_* из linux/mempolicy.h.
+    const int mode = policy == NumaPolicy::Bind ? 2 : 3;
+    const unsigned long mask = policy == NumaPolicy::Bind ? 1UL << node : online_numa_nodes();
+    return syscall(SYS_mbind, addr, bytes, mode, &mask, 64, 0) == 0;
+#else
+    (void)addr, (void)bytes, (void)policy, (void)node;
+    return false;
+#endif
+}
+
+inline size_t stagger_offset(size_t alignment)
+{
+    static std::atomic<unsigned> sequence{0};
+    const size_t offset = (sequence++ % 8) * 17 * alignment;
+    return offset < kHugePageSize ? offset : 0;
+}
+
+// Байты на страницах 2 МБ в области отображения, содержащей addr, по
+// /proc/self/smaps (AnonHugePages для THP, Hugetlb для MAP_HUGETLB).
+// Соседние массивы с тем же madvise ядро может слить в одну область.
+inline size_t huge_bytes_at(const void* addr)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    const uintptr_t target = reinterpret_cast<uintptr_t>(addr);
+    std::string line;
+    bool inside = false;
+    size_t hugetlb = 0;
+    while (std::getline(smaps, line))
+    {
+        std::istringstream in(line);
+        std::string first;
+        in >> first;
+        if (first.empty())
+            continue;
+        if (first.back() != ':')
+        {
+            // Заголовок области: "start-end perms ...".
+            if (inside)
+                break;
+            const size_t dash = first.find('-');
+            const uintptr_t start = std::stoull(first.substr(0, dash), nullptr, 16);
+            const uintptr_t end = std::stoull(first.substr(dash + 1), nullptr, 16);
+            inside = start <= target && target < end;
+            continue;
+        }
+        if (!inside)
+            continue;
+        size_t kb = 0;
+        in >> kb;
+        if (first == "AnonHugePages:" && kb > 0)
+            return kb * 1024;
+        if (first == "Private_Hugetlb:" || first == "Shared_Hugetlb:")
+            hugetlb += kb * 1024;
+    }
+    return hugetlb;
+}
+
+// Владеющий массив count элементов T. Только перемещение, как unique_ptr.
+template<typename T>
+class HugeArray {
+public:
+    HugeArray() = default;
+
+    explicit HugeArray(size_t count, AllocationOptions options = {}) : count_(count)
+    {
+        if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0)
+            throw std::runtime_error("выравнивание должно быть степенью двойки");
+        if (count == 0)
+            return;
+        const size_t offset = options.stagger ? stagger_offset(options.alignment) : 0;
+        const size_t bytes = count * sizeof(T) + offset;
+
+        if (options.pages == Pages::HugeTlb && options.alignment <= kHugePageSize)
+        {
+            // Участок hugetlb выровнен на 2 МБ и длиной кратен 2 МБ.
+            mapped_ = (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+            base_ = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base_ != MAP_FAILED)
+            {
+                pages_ = Pages::HugeTlb;
+                data_ = reinterpret_cast<T*>(static_cast<char*>(base_) + offset);
+                finish(options);
+                return;
+            }
+            base_ = nullptr;
+            options.pages = Pages::Transparent;
+        }
+
+        // Резерв с запасом на выравнивание, лишнее с краёв возвращается.
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t align = std::max(options.alignment,
+                                      options.pages == Pages::Transparent && bytes >= kHugePageSize ? kHugePageSize : page);
+        const size_t length = (bytes + page - 1) / page * page;
+        const size_t reserve = length + (align > page ? align : 0);
+        void* raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::runtime_error("mmap " + std::to_string(reserve) + " байт: " + std::strerror(errno));
+        const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (start + align - 1) / align * align;
+        if (aligned > start)
+            munmap(raw, aligned - start);
+        if (start + reserve > aligned + length)
+            munmap(reinterpret_cast<void*>(aligned + length), start + reserve - aligned - length);
+        base_ = reinterpret_cast<void*>(aligned);
+        mapped_ = length;
+        data_ = reinterpret_cast<T*>(static_cast<char*>(base_) + offset);
+
+        // THP в режиме never или ядро без THP: остаются страницы 4 КБ.
+        const int advice = options.pages == Pages::Transparent ? MADV_HUGEPAGE : MADV_NOHUGEPAGE;
+        pages_ = madvise(base_, mapped_, advice) == 0 ? options.pages : Pages::Small;
+        finish(options);
+    }
+
+    ~HugeArray()
+    {
+        release();
+    }
+
+    HugeArray(const HugeArray&) = delete;
+    HugeArray& operator=(const HugeArray&) = delete;
+
+    HugeArray(HugeArray&& other) noexcept
+    {
+        swap(other);
+    }
+
+    HugeArray& operator=(HugeArray&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return count_; }
+    T& operator[](size_t k) { return data_[k]; }
+    const T& operator[](size_t k) const { return data_[k]; }
+
+    // Подложка, которую удалось получить (после откатов).
+    Pages pages() const { return pages_; }
+    bool numa_applied() const { return numa_applied_; }
+
+    size_t huge_bytes() const
+    {
+        return base_ ? huge_bytes_at(base_) : 0;
+    }
+
+private:
+    void finish(const AllocationOptions& options)
+    {
+        if (options.numa != NumaPolicy::None)
+            numa_applied_ = apply_numa_policy(base_, mapped_, options.numa, options.node);
+    }
+
+    void release()
+    {
+        if (base_)
+            munmap(base_, mapped_);
+        base_ = nullptr;
+        data_ = nullptr;
+        count_ = 0;
+        mapped_ = 0;
+    }
+
+    void swap(HugeArray& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(count_, other.count_);
+        std::swap(base_, other.base_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(pages_, other.pages_);
+        std::swap(numa_applied_, other.numa_applied_);
+    }
+
+    T* data_ = nullptr;
+    size_t count_ = 0;
+    void* base_ = nullptr;
+    size_t mapped_ = 0;
+    Pages pages_ = Pages::Small;
+    bool numa_applied_ = false;
+};
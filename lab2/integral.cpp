@@ -3,6 +3,9 @@
 #include <chrono>
 #include <omp.h>
 #include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
 
 const double PI = 3.14159265358979323846;
 
@@ -52,6 +55,387 @@ double integrate_omp(double (*func)(double), double a, double b, int n, int thre
     return sum;
 }
 
+// Пакетное интегрирование: задания (подынтегральная функция с параметром,
+// отрезок, точность) считаются в общих параллельных проходах. Число узлов
+// для каждого задания берётся из пробных расчётов и проверяется в
+// итоговом проходе (см. integrate_batch).
+// Дальше все узлы режутся на куски примерно по kBatchChunk: большие
+// задания делятся на несколько кусков, маленькие одного типа собираются
+// в один кусок. Узлы куска идут пачками по kBatchBlock через векторную
+// функцию, так что в одном векторе бывают точки разных заданий.
+
+enum class Integrand { Gauss, Cosine, Lorentz };
+
+struct IntegralJob
+{
+    Integrand f;
+    double param;
+    double a;
+    double b;
+    double tolerance;
+};
+
+struct IntegralResult
+{
+    double value;
+    double error;
+    long n;
+};
+
+const long kBatchChunk = 1 << 15;
+const int kBatchBlock = 256;
+const long kBatchMaxSteps = 1L << 28;
+
+double integrand_scalar(Integrand f, double x, double p)
+{
+    switch (f)
+    {
+    case Integrand::Gauss:
+        return exp(-p * x * x);
+    case Integrand::Cosine:
+        return cos(p * x);
+    default:
+        return 1.0 / (1.0 + p * x * x);
+    }
+}
+
+void eval_integrand_scalar(Integrand f, const double *x, const double *p, double *out, int n)
+{
+    for (int k = 0; k < n; k++)
+        out[k] = integrand_scalar(f, x[k], p[k]);
+}
+
+#if defined(__x86_64__) && defined(__GLIBC__)
+#include <immintrin.h>
+
+// Векторные exp и cos из libmvec (glibc), точность в пределах 4 ulp.
+extern "C" __m256d _ZGVdN4v_exp(__m256d);
+extern "C" __m256d _ZGVdN4v_cos(__m256d);
+
+__attribute__((target("avx2,fma")))
+void eval_integrand_avx2(Integrand f, const double *x, const double *p, double *out, int n)
+{
+    int k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        __m256d vx = _mm256_loadu_pd(x + k);
+        __m256d vp = _mm256_loadu_pd(p + k);
+        __m256d y;
+        if (f == Integrand::Gauss)
+            y = _ZGVdN4v_exp(_mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), vp), _mm256_mul_pd(vx, vx)));
+        else if (f == Integrand::Cosine)
+            y = _ZGVdN4v_cos(_mm256_mul_pd(vp, vx));
+        else
+            y = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(vp, _mm256_mul_pd(vx, vx))));
+        _mm256_storeu_pd(out + k, y);
+    }
+    eval_integrand_scalar(f, x + k, p + k, out + k, n - k);
+}
+
+void eval_integrand(Integrand f, const double *x, const double *p, double *out, int n)
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (has_avx2)
+        eval_integrand_avx2(f, x, p, out, n);
+    else
+        eval_integrand_scalar(f, x, p, out, n);
+}
+#else
+void eval_integrand(Integrand f, const double *x, const double *p, double *out, int n)
+{
+    eval_integrand_scalar(f, x, p, out, n);
+}
+#endif
+
+// Кусок работы: узлы [first, last) задания job с шагом h.
+struct BatchSegment
+{
+    int job;
+    long first;
+    long last;
+};
+
+// Суммы f по сегментам (без умножения на h); все сегменты одного куска
+// относятся к заданиям с одной и той же функцией. thirds — суммы по
+// узлам i = 3k + 1: это узлы формулы с шагом 3h, проверка даётся даром.
+void sum_segments(const std::vector<IntegralJob> &jobs, const std::vector<long> &steps,
+                  const std::vector<BatchSegment> &segments, size_t begin, size_t end, double *sums, double *thirds)
+{
+    double x[kBatchBlock], p[kBatchBlock], y[kBatchBlock];
+    int owner[kBatchBlock];
+    bool third[kBatchBlock];
+    const Integrand f = jobs[segments[begin].job].f;
+    int filled = 0;
+
+    auto flush = [&]() {
+        eval_integrand(f, x, p, y, filled);
+        for (int k = 0; k < filled; k++)
+        {
+            sums[owner[k]] += y[k];
+            thirds[owner[k]] += third[k] ? y[k] : 0.0;
+        }
+        filled = 0;
+    };
+
+    for (size_t s = begin; s < end; s++)
+    {
+        const IntegralJob &job = jobs[segments[s].job];
+        const double h = (job.b - job.a) / steps[segments[s].job];
+        sums[s] = 0.0;
+        thirds[s] = 0.0;
+        for (long i = segments[s].first; i < segments[s].last; i++)
+        {
+            x[filled] = job.a + h * (i + 0.5);
+            p[filled] = job.param;
+            owner[filled] = static_cast<int>(s);
+            third[filled] = i % 3 == 1;
+            if (++filled == kBatchBlock)
+                flush();
+        }
+    }
+    if (filled > 0)
+        flush();
+}
+
+// Один проход: сумма по steps[j] узлам для каждого задания. Куски
+// раздаются потокам динамически; порядок сложения кусков фиксирован,
+// поэтому результат не зависит от числа потоков. Если задан coarse, в
+// него пишется M(steps[j] / 3) для steps[j], кратных 3.
+std::vector<double> midpoint_batch(const std::vector<IntegralJob> &jobs, const std::vector<long> &steps, int threads,
+                                   std::vector<double> *coarse = nullptr)
+{
+    std::vector<int> order(jobs.size());
+    for (size_t j = 0; j < jobs.size(); j++)
+        order[j] = static_cast<int>(j);
+    std::stable_sort(order.begin(), order.end(), [&](int l, int r) { return jobs[l].f < jobs[r].f; });
+
+    std::vector<BatchSegment> segments;
+    std::vector<size_t> chunks;
+    long in_chunk = 0;
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        const int j = order[k];
+        if (in_chunk > 0 && (k == 0 || jobs[order[k - 1]].f != jobs[j].f))
+            in_chunk = kBatchChunk;
+        for (long first = 0; first < steps[j];)
+        {
+            if (chunks.empty() || in_chunk >= kBatchChunk)
+            {
+                chunks.push_back(segments.size());
+                in_chunk = 0;
+            }
+            const long last = std::min(steps[j], first + (kBatchChunk - in_chunk));
+            segments.push_back({j, first, last});
+            in_chunk += last - first;
+            first = last;
+        }
+    }
+    chunks.push_back(segments.size());
+
+    std::vector<double> partial(segments.size()), partial_thirds(segments.size());
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+    for (long c = 0; c < static_cast<long>(chunks.size()) - 1; c++)
+        sum_segments(jobs, steps, segments, chunks[c], chunks[c + 1], partial.data(), partial_thirds.data());
+
+    std::vector<double> sums(jobs.size(), 0.0), thirds(jobs.size(), 0.0);
+    for (size_t s = 0; s < segments.size(); s++)
+    {
+        sums[segments[s].job] += partial[s];
+        thirds[segments[s].job] += partial_thirds[s];
+    }
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        const double h = (jobs[j].b - jobs[j].a) / steps[j];
+        sums[j] *= h;
+        thirds[j] *= 3.0 * h;
+    }
+    if (coarse)
+        *coarse = thirds;
+    return sums;
+}
+
+// Задания с номерами open и их числа узлов — для прохода по части пакета.
+void select_jobs(const std::vector<IntegralJob> &jobs, const std::vector<long> &steps, const std::vector<int> &open,
+                 std::vector<IntegralJob> &sub_jobs, std::vector<long> &sub_steps)
+{
+    sub_jobs.clear();
+    sub_steps.clear();
+    for (int j : open)
+    {
+        sub_jobs.push_back(jobs[j]);
+        sub_steps.push_back(steps[j]);
+    }
+}
+
+// Наименьшее кратное 3 не меньше n, но не больше kBatchMaxSteps.
+long steps_multiple_of_3(double n)
+{
+    const long limit = kBatchMaxSteps / 3 * 3;
+    if (!(n < limit))
+        return limit;
+    return std::max(3L, static_cast<long>(ceil(n / 3.0)) * 3);
+}
+
+// У формулы средних прямоугольников ошибка ~ K / n^2. Пробный шаг
+// удваивается с 32, пока оценка K (по M(n) - M(2n) = 3K / 4n^2) растёт
+// больше чем вдвое от предыдущей: на слишком грубой сетке узкий пик
+// exp(-p x^2) проваливается между узлами, обе суммы почти нулевые, и K
+// растёт, пока сетка не разрешит пик. Убывающая K — сетка уже разрешает
+// функцию (у гладких функций с быстро убывающими хвостами ошибка падает
+// быстрее 1 / n^2); пока она падает в разы, удвоение продолжается, если
+// оно дешевле итогового прохода по текущей K. Пик уже шага пробной сетки не виден никакой оценке по
+// узлам: это ограничение метода, а не проверки.
+// Итоговое n кратно 3, и в том же проходе считается M(n / 3):
+// M(n / 3) - M(n) = 8K / n^2. Если эта ошибка больше допуска, n растёт по
+// наблюдаемому K и проход повторяется для оставшихся заданий. Отчётная
+// ошибка — не меньше оценки по последнему наблюдаемому расхождению.
+std::vector<IntegralResult> integrate_batch(const std::vector<IntegralJob> &jobs, int threads)
+{
+    const size_t count = jobs.size();
+    std::vector<long> pilot(count, 32);
+    std::vector<double> previous = midpoint_batch(jobs, pilot, threads);
+    std::vector<double> constant(count, 0.0), last_constant(count, -1.0);
+    std::vector<int> open(count);
+    for (size_t j = 0; j < count; j++)
+        open[j] = static_cast<int>(j);
+
+    std::vector<IntegralJob> sub_jobs;
+    std::vector<long> sub_steps;
+    while (!open.empty())
+    {
+        std::vector<long> doubled(pilot);
+        for (long &n : doubled)
+            n *= 2;
+        select_jobs(jobs, doubled, open, sub_jobs, sub_steps);
+        const std::vector<double> finer = midpoint_batch(sub_jobs, sub_steps, threads);
+
+        std::vector<int> next;
+        for (size_t k = 0; k < open.size(); k++)
+        {
+            const int j = open[k];
+            const double n = static_cast<double>(pilot[j]);
+            const double estimate = fabs(previous[j] - finer[k]) * 4.0 * n * n / 3.0;
+            const double before = last_constant[j];
+            previous[j] = finer[k];
+            pilot[j] *= 2;
+            last_constant[j] = estimate;
+            constant[j] = estimate;
+            // K ещё падает в разы, а по ней нужно больше узлов, чем стоит
+            // следующий пробный шаг, — дешевле удвоить ещё раз.
+            const bool falling = estimate < 0.5 * before &&
+                                 sqrt(2.0 * estimate / jobs[j].tolerance) > 2.0 * pilot[j];
+            const bool settled = before >= 0.0 && estimate <= 2.0 * before && !falling;
+            if (!settled && pilot[j] < kBatchMaxSteps / 2)
+                next.push_back(j);
+        }
+        open.swap(next);
+    }
+
+    std::vector<long> steps(count);
+    for (size_t j = 0; j < count; j++)
+        steps[j] = steps_multiple_of_3(std::max(2.0 * pilot[j], sqrt(2.0 * constant[j] / jobs[j].tolerance)));
+
+    std::vector<IntegralResult> results(count);
+    for (size_t j = 0; j < count; j++)
+        open.push_back(static_cast<int>(j));
+    while (!open.empty())
+    {
+        select_jobs(jobs, steps, open, sub_jobs, sub_steps);
+        std::vector<double> coarse;
+        const std::vector<double> values = midpoint_batch(sub_jobs, sub_steps, threads, &coarse);
+
+        std::vector<int> next;
+        for (size_t k = 0; k < open.size(); k++)
+        {
+            const int j = open[k];
+            const double n = static_cast<double>(steps[j]);
+            const double observed = fabs(coarse[k] - values[k]) / 8.0;
+            const double predicted = constant[j] / (n * n);
+            results[j] = {values[k], std::max(observed, predicted), steps[j]};
+            if (observed > jobs[j].tolerance && steps[j] < kBatchMaxSteps / 3 * 3)
+            {
+                constant[j] = std::max(constant[j], observed * n * n);
+                steps[j] = steps_multiple_of_3(std::max(3.0 * n, sqrt(2.0 * constant[j] / jobs[j].tolerance)));
+                next.push_back(j);
+            }
+        }
+        open.swap(next);
+    }
+    return results;
+}
+
+double exact_integral(const IntegralJob &job)
+{
+    const double p = job.param;
+    switch (job.f)
+    {
+    case Integrand::Gauss:
+        return sqrt(PI / p) / 2.0 * (erf(sqrt(p) * job.b) - erf(sqrt(p) * job.a));
+    case Integrand::Cosine:
+        return (sin(p * job.b) - sin(p * job.a)) / p;
+    default:
+        return (atan(sqrt(p) * job.b) - atan(sqrt(p) * job.a)) / sqrt(p);
+    }
+}
+
+// integrate_omp принимает функцию без параметра: параметр задания
+// передаётся через глобальную переменную.
+double loop_param = 1.0;
+double gauss_loop(double x) { return exp(-loop_param * x * x); }
+double cosine_loop(double x) { return cos(loop_param * x); }
+double lorentz_loop(double x) { return 1.0 / (1.0 + loop_param * x * x); }
+
+// Задания разных размеров: точность от 1e-6 до 1e-10, отрезки разной длины.
+std::vector<IntegralJob> make_jobs(int count)
+{
+    std::vector<IntegralJob> jobs;
+    for (int k = 0; k < count; k++)
+    {
+        const Integrand f = static_cast<Integrand>(k % 3);
+        const double param = 0.5 + (k % 10) * 0.3;
+        const double a = -1.0 - (k % 7);
+        const double b = 1.0 + (k % 5) * 0.5;
+        jobs.push_back({f, param, a, b, pow(10.0, -6 - (k % 5))});
+    }
+    return jobs;
+}
+
+void run_batch(int count, int threads)
+{
+    const std::vector<IntegralJob> jobs = make_jobs(count);
+
+    auto start{std::chrono::steady_clock::now()};
+    const std::vector<IntegralResult> results = integrate_batch(jobs, threads);
+    const double batch_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long total_steps = 0;
+    double worst = 0.0;
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        total_steps += results[j].n;
+        worst = std::max(worst, fabs(results[j].value - exact_integral(jobs[j])) / jobs[j].tolerance);
+    }
+
+    // Те же задания с тем же числом узлов через integrate_omp по одному.
+    // Его точность не сравнивается: integrate_omp пропускает последний
+    // узел каждого потока.
+    double loop_sum = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        loop_param = jobs[j].param;
+        double (*f)(double) = jobs[j].f == Integrand::Gauss ? gauss_loop
+                            : jobs[j].f == Integrand::Cosine ? cosine_loop : lorentz_loop;
+        loop_sum += integrate_omp(f, jobs[j].a, jobs[j].b, static_cast<int>(results[j].n), threads);
+    }
+    const double loop_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Batch: %d integrals, %d threads, %ld nodes in total\n", count, threads, total_steps);
+    printf("integrate_omp loop: %.6f s, %.1f integrals/s (checksum %.6f)\n", loop_time, count / loop_time, loop_sum);
+    printf("integrate_batch:    %.6f s, %.1f integrals/s, max error / tolerance %.3f (x%.2f)\n", batch_time,
+           count / batch_time, worst, loop_time / batch_time);
+}
+
 double run_serial(double (*func)(double), int nsteps)
 {
     const auto start{std::chrono::steady_clock::now()};
@@ -72,6 +456,15 @@ double run_parallel(int threads)
 }
 int main(int argc, char **argv)
 {
+    // ./integral batch [count] [threads] — пакет против цикла integrate_omp.
+    if (argc > 1 && strcmp(argv[1], "batch") == 0)
+    {
+        const int count = argc > 2 ? atoi(argv[2]) : 3000;
+        const int threads = argc > 3 ? atoi(argv[3]) : omp_get_max_threads();
+        run_batch(count, threads);
+        return 0;
+    }
+
     printf("Integration f(x) on [%.12f, %.12f], nsteps = %d\n", a, b, nsteps);
     
     printf("Execution time (serial): %.6f\n", run_serial(func, nsteps));
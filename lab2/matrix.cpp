@@ -2,6 +2,9 @@
 #include <stdio.h>
 #include <chrono>
 #include <omp.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../common/huge_pages.h"
 
 void matrix_vector_product(double *a, double *b, double *c, int m, int n)
 {
@@ -15,10 +18,7 @@ void matrix_vector_product(double *a, double *b, double *c, int m, int n)
 
 const auto run_serial(int m = 20000, int n = 20000)
 {
-    double *a, *b, *c;
-    a = (double *)malloc(sizeof(*a) * m * n);
-    b = (double *)malloc(sizeof(*b) * n);
-    c = (double *)malloc(sizeof(*c) * m);
+    HugeArray<double> a(static_cast<size_t>(m) * n), b(n), c(m);
 
     for (int i = 0; i < m; i++)
     {
@@ -30,15 +30,11 @@ const auto run_serial(int m = 20000, int n = 20000)
         b[j] = j;
 
     const auto start{std::chrono::steady_clock::now()};
-    matrix_vector_product(a, b, c, m, n);
+    matrix_vector_product(a.data(), b.data(), c.data(), m, n);
     const auto end{std::chrono::steady_clock::now()};
     const auto elapsed_ms{std::chrono::duration<double>(end - start).count()};
     std::cout << "Time taken for serial execution: " << elapsed_ms << "s" << std::endl;
 
-    free(a);
-    free(b);
-    free(c);
-
     return elapsed_ms;
 }
 
@@ -59,11 +55,7 @@ void matrix_vector_product_omp(double *a, double *b, double *c, int m, int n, in
 
 const auto run_parallel(int num_threads = 4, int m = 20000, int n = 20000)
 {
-    double *a, *b, *c;
-
-    a = (double*)malloc(sizeof(*a) * m * n);
-    b = (double*)malloc(sizeof(*b) * n);
-    c = (double*)malloc(sizeof(*c) * m);
+    HugeArray<double> a(static_cast<size_t>(m) * n), b(n), c(m);
 
     for (int i = 0; i < m; i++)
     {
@@ -76,20 +68,61 @@ const auto run_parallel(int num_threads = 4, int m = 20000, int n = 20000)
 
     
     const auto start{std::chrono::steady_clock::now()};
-    matrix_vector_product_omp(a, b, c, m, n, num_threads);
+    matrix_vector_product_omp(a.data(), b.data(), c.data(), m, n, num_threads);
     const auto end{std::chrono::steady_clock::now()};
     const auto elapsed_ms{std::chrono::duration<double>(end - start).count()};
     std::cout << "Time taken for parallel execution with threads: " << num_threads << " " << elapsed_ms << "s" << std::endl;
 
-    free(a);
-    free(b);
-    free(c);
-
     return elapsed_ms;
 }
 
-int main()
+// Умножение матрицы на вектор на страницах 4 КБ и 2 МБ (THP и hugetlb;
+// без пула hugetlb откатывается на THP). Матрица сначала заполняется
+// параллельно, поэтому время первого касания печатается отдельно.
+void run_pages(int m, int n, int threads)
+{
+    const Pages modes[] = {Pages::Small, Pages::Transparent, Pages::HugeTlb};
+    printf("Matrix %dx%d (%.2f GB), threads: %d\n", m, n, 8.0 * m * n / 1e9, threads);
+    for (Pages mode : modes)
+    {
+        AllocationOptions options;
+        options.pages = mode;
+
+        auto start{std::chrono::steady_clock::now()};
+        HugeArray<double> a(static_cast<size_t>(m) * n, options), b(n, options), c(m, options);
+        #pragma omp parallel for num_threads(threads)
+        for (int i = 0; i < m; i++)
+        {
+            for (int j = 0; j < n; j++)
+                a[static_cast<size_t>(i) * n + j] = i + j;
+        }
+        for (int j = 0; j < n; j++)
+            b[j] = j;
+        const double touch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double best = 1e30;
+        for (int r = 0; r < 5; r++)
+        {
+            start = std::chrono::steady_clock::now();
+            matrix_vector_product_omp(a.data(), b.data(), c.data(), m, n, threads);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        printf("%-8s (got %-7s, %5.1f%% on 2 MB pages): first touch %.3f s, matvec %.4f s, %.2f GB/s\n",
+               pages_name(mode), pages_name(a.pages()), 100.0 * a.huge_bytes() / (8.0 * m * n), touch, best,
+               8.0 * m * n / best / 1e9);
+    }
+}
+
+int main(int argc, char **argv)
 {
+    // ./matrix pages [size] [threads] — страницы 4 КБ против 2 МБ.
+    if (argc > 1 && strcmp(argv[1], "pages") == 0)
+    {
+        const int size = argc > 2 ? atoi(argv[2]) : 20000;
+        run_pages(size, size, argc > 3 ? atoi(argv[3]) : omp_get_max_threads());
+        return 0;
+    }
+
     int matrix = 40000;
     run_serial(matrix, matrix);
     run_parallel(2, matrix, matrix);
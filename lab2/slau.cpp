@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <chrono>
 #include <omp.h>
+#include "../common/huge_pages.h"
 
 double norm(double* vector, int n)
 {
@@ -19,9 +20,9 @@ bool crit(double* x, double* y, double eps, int n)
     return norm(x, n) / norm(y, n) < eps;
 }
 
-double* data_matrix(int m, int n)
+HugeArray<double> data_matrix(int m, int n)
 {
-    double *matrix = (double *)malloc(sizeof(*matrix) * m * n);
+    HugeArray<double> matrix(static_cast<size_t>(m) * n);
     for (int i = 0; i < m; i++)
     {
         for (int j = 0; j < n; j++)
@@ -167,7 +168,7 @@ int main()
     double eps = 0.00001;
 
     int n = 10000;
-    double *matrix = data_matrix(n, n);
+    HugeArray<double> matrix = data_matrix(n, n);
 
     double *b = (double *)malloc(sizeof(*b) * n);
     for (int j = 0; j < n; j++)
@@ -175,10 +176,9 @@ int main()
 
     int var = 2;
     
-    double *x1 = solve(matrix, b, tau, eps, n, 8, var);
+    double *x1 = solve(matrix.data(), b, tau, eps, n, 8, var);
     
     free(x1);
-    free(matrix);
     free(b);
     
     return 0;
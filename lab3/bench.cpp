@@ -0,0 +1,366 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include "server.h"
+#include "result_sink.h"
+
+namespace po = boost::program_options;
+
+using bench_clock = std::chrono::steady_clock;
+
+double percentile(std::vector<double> &samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+    size_t k = static_cast<size_t>(p / 100.0 * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+// Одиночные запросы с паузой между ними: сервер каждый раз успевает
+// уснуть, так что задержка почти целиком состоит из пробуждений.
+void bench_latency(size_t requests, int gap_us)
+{
+    Server<double> server;
+    server.start();
+
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    for (size_t i = 0; i < requests; ++i)
+    {
+        double arg = 0.1 + (i % 50) / 10.0;
+        const auto start{bench_clock::now()};
+        size_t id = server.add_task([arg]() { return fun_sin(arg); });
+        server.request_result(id);
+        const auto end{bench_clock::now()};
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+    }
+    server.stop();
+
+    std::cout << "Запросов: " << requests << ", пауза: " << gap_us << " мкс\n";
+    std::cout << "p50: " << percentile(latencies, 50) << " мкс\n";
+    std::cout << "p99: " << percentile(latencies, 99) << " мкс\n";
+}
+
+std::function<double()> make_task(int client_type, double arg1, double arg2)
+{
+    if (client_type == 0)
+        return [arg1]() { return fun_sin(arg1); };
+    if (client_type == 1)
+        return [arg1]() { return fun_sqrt(arg1); };
+    return [arg1, arg2]() { return fun_pow(arg1, arg2); };
+}
+
+double rounded_arg(std::mt19937 &gen)
+{
+    std::uniform_real_distribution<> dist(0.1, 5.0);
+    return std::round(dist(gen) * 10) / 10.0;
+}
+
+// Как в task2.cpp: три потока-клиента, каждый сначала отправляет все свои
+// задачи, а потом забирает результаты по id.
+double run_thread_clients(size_t total_tasks)
+{
+    Server<double> server;
+    server.start();
+    const auto start{bench_clock::now()};
+    std::vector<std::thread> clients;
+    for (int type = 0; type < 3; ++type)
+    {
+        clients.emplace_back([&server, type, total_tasks]() {
+            std::mt19937 gen(type);
+            std::vector<size_t> ids;
+            for (size_t i = 0; i < total_tasks / 3; ++i)
+                ids.push_back(server.add_task(make_task(type, rounded_arg(gen), rounded_arg(gen))));
+            for (size_t id : ids)
+                server.request_result(id);
+        });
+    }
+    for (auto &client : clients)
+        client.join();
+    const auto end{bench_clock::now()};
+    server.stop();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+EventLoop::ClientTask coro_client(Server<double> &server, int type, size_t tasks, double &sink)
+{
+    std::mt19937 gen(type);
+    for (size_t i = 0; i < tasks; ++i)
+        sink += co_await server.submit(make_task(type, rounded_arg(gen), rounded_arg(gen)));
+}
+
+// Тысячи логических клиентов на нескольких потоках EventLoop.
+double run_coro_clients(size_t total_tasks, size_t clients, int loops)
+{
+    Server<double> server;
+    server.start();
+    const auto start{bench_clock::now()};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < loops; ++t)
+    {
+        threads.emplace_back([&server, t, loops, clients, total_tasks]() {
+            EventLoop loop;
+            double sink = 0.0;
+            for (size_t c = t; c < clients; c += loops)
+                loop.spawn(coro_client(server, c % 3, total_tasks / clients, sink));
+            loop.run();
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    const auto end{bench_clock::now()};
+    server.stop();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void bench_coro(size_t total_tasks, size_t clients, int loops)
+{
+    double threads_time = run_thread_clients(total_tasks);
+    double coro_time = run_coro_clients(total_tasks, clients, loops);
+    std::cout << "Задач: " << total_tasks << "\n";
+    std::cout << "3 потока-клиента: " << threads_time << " с, "
+              << total_tasks / threads_time << " задач/с\n";
+    std::cout << clients << " корутин на " << loops << " потоках: " << coro_time << " с, "
+              << total_tasks / coro_time << " задач/с\n";
+}
+
+// Клиент low держит в очереди backlog дешёвых pow, пока клиент high раз в
+// interval_us отправляет одиночный sin со сроком deadline_us.
+void run_priority(Priority flood_priority, size_t requests, int interval_us, int deadline_us, size_t backlog)
+{
+    Server<double> server;
+    server.start();
+    std::atomic<bool> flooding{true};
+    std::thread flood([&]() {
+        std::mt19937 gen(2);
+        std::vector<size_t> ids;
+        while (flooding.load(std::memory_order_relaxed))
+        {
+            for (size_t i = 0; i < backlog; ++i)
+                ids.push_back(server.add_task(make_task(2, rounded_arg(gen), rounded_arg(gen)), {flood_priority}));
+            for (size_t id : ids)
+                server.request_result(id);
+            ids.clear();
+        }
+    });
+
+    std::mt19937 gen(0);
+    TaskOptions high{Priority::High, std::chrono::microseconds(deadline_us)};
+    std::vector<double> latencies;
+    for (size_t i = 0; i < requests; ++i)
+    {
+        const auto start{bench_clock::now()};
+        server.request_result(server.add_task(make_task(0, rounded_arg(gen), 0.0), high));
+        const auto end{bench_clock::now()};
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+    }
+    flooding = false;
+    flood.join();
+    server.stop();
+    std::cout << "Клиент sin: p50 " << percentile(latencies, 50) << " мкс, p99 "
+              << percentile(latencies, 99) << " мкс\n";
+    server.print_stats(std::cout);
+}
+
+void bench_priority(size_t requests, int interval_us, int deadline_us, size_t backlog)
+{
+    std::cout << "Поток pow в классе low:\n";
+    run_priority(Priority::Low, requests, interval_us, deadline_us, backlog);
+    std::cout << "\nПоток pow в классе high (FIFO с запросами):\n";
+    run_priority(Priority::High, requests, interval_us, deadline_us, backlog);
+}
+
+// Три клиента отправляют по total_tasks / 3 задач и забирают результаты.
+// mixed — каждый клиент шлёт свою операцию, иначе все шлют sin.
+double run_ops(size_t total_tasks, bool typed, bool mixed, size_t cache_capacity = 0)
+{
+    Server<double> server;
+    if (cache_capacity)
+        server.enable_cache(cache_capacity);
+    server.start();
+    const auto start{bench_clock::now()};
+    std::vector<std::thread> clients;
+    for (int c = 0; c < 3; ++c)
+    {
+        clients.emplace_back([&server, c, total_tasks, typed, mixed]() {
+            const int type = mixed ? c : 0;
+            const Op op = type == 0 ? Op::Sin : (type == 1 ? Op::Sqrt : Op::Pow);
+            std::mt19937 gen(c);
+            std::vector<size_t> ids;
+            ids.reserve(total_tasks / 3);
+            for (size_t i = 0; i < total_tasks / 3; ++i)
+            {
+                double a = rounded_arg(gen);
+                double b = rounded_arg(gen);
+                ids.push_back(typed ? server.add_op(op, a, b) : server.add_task(make_task(type, a, b)));
+            }
+            for (size_t id : ids)
+                server.request_result(id);
+        });
+    }
+    for (auto &client : clients)
+        client.join();
+    const auto end{bench_clock::now()};
+    server.stop();
+    if (server.cache())
+        std::cout << "  попаданий в кэш: " << server.cache()->hit_rate() * 100 << "%\n";
+    return total_tasks / std::chrono::duration<double>(end - start).count();
+}
+
+// Нагрузка клиентов task2: ~50 разных аргументов sin/sqrt и ~2500 пар pow.
+void bench_memo(size_t total_tasks, size_t capacity)
+{
+    double plain = run_ops(total_tasks, true, true);
+    double cached = run_ops(total_tasks, true, true, capacity);
+    std::cout << "Без кэша: " << plain << " задач/с\n";
+    std::cout << "С кэшем на " << capacity << " записей: " << cached << " задач/с (x" << cached / plain << ")\n";
+}
+
+// Время, которое клиент тратит на вывод N результатов pow: прежний путь
+// (строка с деталями + ofstream) против записи в асинхронный сток.
+void bench_sink(size_t n)
+{
+    std::mt19937 gen(0);
+    std::vector<ResultRecord> records(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double a = rounded_arg(gen);
+        double b = rounded_arg(gen);
+        records[i] = {i + 1, a, b, fun_pow(a, b), static_cast<uint32_t>(Op::Pow), 0};
+    }
+
+    auto start = bench_clock::now();
+    {
+        std::ofstream out("bench_results.txt");
+        for (auto &r : records)
+        {
+            std::string details = "операция: pow, числа: " + std::to_string(r.a) + " и " + std::to_string(r.b);
+            out << "Task ID " << r.id << " " << details << " результат: " << r.result << "\n";
+        }
+    }
+    double ofstream_time = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    double sink_time[2];
+    for (int f = 0; f < 2; ++f)
+    {
+        ResultSink sink(f == 0 ? SinkFormat::Binary : SinkFormat::Csv);
+        auto &channel = sink.open(f == 0 ? "bench_results.bin" : "bench_results.csv");
+        sink.start();
+        start = bench_clock::now();
+        for (auto &r : records)
+            channel.push(r);
+        sink_time[f] = std::chrono::duration<double>(bench_clock::now() - start).count();
+        sink.close();
+    }
+
+    std::cout << "Записей: " << n << ", время клиента на вывод:\n";
+    std::cout << "  ofstream + to_string: " << ofstream_time << " с\n";
+    std::cout << "  сток, binary:         " << sink_time[0] << " с (x" << ofstream_time / sink_time[0] << ")\n";
+    std::cout << "  сток, csv:            " << sink_time[1] << " с (x" << ofstream_time / sink_time[1] << ")\n";
+}
+
+// Только фаза вычисления: пакетное ядро против вызова std::function на задачу.
+void bench_kernels(size_t n)
+{
+    std::mt19937 gen(0);
+    std::vector<double> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = rounded_arg(gen);
+        b[i] = rounded_arg(gen);
+    }
+    for (int type = 0; type < 3; ++type)
+    {
+        const Op op = type == 0 ? Op::Sin : (type == 1 ? Op::Sqrt : Op::Pow);
+        std::vector<std::function<double()>> tasks;
+        tasks.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            tasks.push_back(make_task(type, a[i], b[i]));
+
+        auto start = bench_clock::now();
+        for (size_t i = 0; i < n; ++i)
+            out[i] = tasks[i]();
+        double scalar = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+        start = bench_clock::now();
+        eval_batch(op, a.data(), b.data(), out.data(), n);
+        double batched = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+        std::cout << "  " << op_name(op) << ": лямбды " << n / scalar << " оп/с, пакет "
+                  << n / batched << " оп/с (x" << scalar / batched << ")\n";
+    }
+}
+
+void bench_ops(size_t total_tasks)
+{
+    std::cout << "Фаза вычисления:\n";
+    bench_kernels(total_tasks);
+    for (bool mixed : {false, true})
+    {
+        double lambdas = run_ops(total_tasks, false, mixed);
+        double typed = run_ops(total_tasks, true, mixed);
+        std::cout << (mixed ? "Смешанная очередь" : "Однородная очередь (sin)") << ":\n";
+        std::cout << "  лямбды:         " << lambdas << " задач/с\n";
+        std::cout << "  типизированные: " << typed << " задач/с (x" << typed / lambdas << ")\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string mode;
+    size_t requests;
+    int gap_us;
+    size_t tasks;
+    size_t clients;
+    int loops;
+    int deadline_us;
+    size_t backlog;
+    size_t cache_capacity;
+
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("mode", po::value<std::string>(&mode)->default_value("latency"))
+    ("requests", po::value<size_t>(&requests)->default_value(10000))
+    ("gap_us", po::value<int>(&gap_us)->default_value(200))
+    ("tasks", po::value<size_t>(&tasks)->default_value(300000))
+    ("clients", po::value<size_t>(&clients)->default_value(10000))
+    ("loops", po::value<int>(&loops)->default_value(2))
+    ("deadline_us", po::value<int>(&deadline_us)->default_value(1000))
+    ("backlog", po::value<size_t>(&backlog)->default_value(10000))
+    ("cache", po::value<size_t>(&cache_capacity)->default_value(4096));
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (mode == "latency")
+        bench_latency(requests, gap_us);
+    else if (mode == "coro")
+        bench_coro(tasks, clients, loops);
+    else if (mode == "ops")
+        bench_ops(tasks);
+    else if (mode == "sink")
+        bench_sink(tasks);
+    else if (mode == "memo")
+        bench_memo(tasks, cache_capacity);
+    else if (mode == "priority")
+        bench_priority(requests, gap_us, deadline_us, backlog);
+    else
+    {
+        std::cerr << "Неизвестный режим: " << mode << std::endl;
+        return 1;
+    }
+    return 0;
+}
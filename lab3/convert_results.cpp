@@ -0,0 +1,44 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "result_sink.h"
+
+// Переводит бинарный файл стока в прежний текстовый формат task2:
+// "Task ID <id> операция: <op>, число: <arg> результат: <res>".
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Использование: " << argv[0] << " <results.bin> <results.txt>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Не получилось открыть файл " << argv[1] << std::endl;
+        return 1;
+    }
+    std::ofstream out(argv[2]);
+    if (!out.is_open())
+    {
+        std::cerr << "Не получилось открыть файл " << argv[2] << std::endl;
+        return 1;
+    }
+
+    ResultRecord record;
+    size_t count = 0;
+    while (in.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        const Op op = static_cast<Op>(record.op);
+        out << "Task ID " << record.id << " операция: " << op_name(op);
+        if (op == Op::Pow)
+            out << ", числа: " << std::to_string(record.a) << " и " << std::to_string(record.b);
+        else
+            out << ", число: " << std::to_string(record.a);
+        out << " результат: " << record.result << "\n";
+        count++;
+    }
+    std::cout << argv[1] << ": " << count << " записей" << std::endl;
+    return 0;
+}
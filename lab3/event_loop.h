@@ -0,0 +1,87 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Однопоточный цикл клиентских корутин. Сервер вызывает post() из своего
+// потока, когда задача готова, а сами корутины возобновляются только здесь,
+// поэтому клиентский код никогда не выполняется в потоке сервера.
+class EventLoop {
+public:
+    struct ClientTask {
+        struct promise_type {
+            ClientTask get_return_object()
+            {
+                return ClientTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept
+            {
+                struct Finish {
+                    bool await_ready() noexcept { return true; }
+                    void await_suspend(std::coroutine_handle<>) noexcept {}
+                    void await_resume() noexcept { EventLoop::current()->live_--; }
+                };
+                return Finish{};
+            }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    static EventLoop* current()
+    {
+        return current_;
+    }
+
+    void spawn(ClientTask task)
+    {
+        live_++;
+        post(task.handle);
+    }
+
+    void post(std::coroutine_handle<> handle)
+    {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            wake = incoming_.empty();
+            incoming_.push_back(handle);
+        }
+        if (wake)
+            cv_.notify_one();
+    }
+
+    // Крутится, пока живы порождённые корутины.
+    void run()
+    {
+        EventLoop* prev = current_;
+        current_ = this;
+        std::vector<std::coroutine_handle<>> ready;
+        while (live_ > 0)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [&]() { return !incoming_.empty(); });
+                ready.swap(incoming_);
+            }
+            for (auto handle : ready)
+                handle.resume();
+            ready.clear();
+        }
+        current_ = prev;
+    }
+
+private:
+    std::vector<std::coroutine_handle<>> incoming_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    size_t live_ = 0;
+
+    static inline thread_local EventLoop* current_ = nullptr;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+
+// Логарифмическая гистограмма в духе HDR: каждая двоичная декада делится
+// на 16 корзин, так что относительная ошибка значения не больше ~6%.
+// Запись — один relaxed fetch_add, читать можно параллельно с записью.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBits;
+    static constexpr size_t kBuckets = kSubBuckets + (64 - kSubBits) * kSubBuckets;
+
+    LatencyHistogram()
+    {
+        reset();
+    }
+
+    void record(uint64_t value)
+    {
+        counts_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (value > prev && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+            ;
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+            if (c)
+                counts_[i].fetch_add(c, std::memory_order_relaxed);
+        }
+        total_.fetch_add(other.count(), std::memory_order_relaxed);
+        uint64_t other_max = other.max();
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (other_max > prev && !max_.compare_exchange_weak(prev, other_max, std::memory_order_relaxed))
+            ;
+    }
+
+    void reset()
+    {
+        for (auto &c : counts_)
+            c.store(0, std::memory_order_relaxed);
+        total_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const
+    {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const
+    {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    // Верхняя граница корзины, в которую попал p-й перцентиль.
+    uint64_t percentile(double p) const
+    {
+        uint64_t total = count();
+        if (total == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+        if (rank == 0)
+            rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(bucket_upper(i), max());
+        }
+        return max();
+    }
+
+    // Значения хранятся в наносекундах, печатаем в микросекундах.
+    void print(std::ostream &out, const char *name) const
+    {
+        out << std::setw(10) << name
+            << " n=" << std::setw(9) << count()
+            << " p50=" << std::setw(10) << percentile(50) / 1000.0
+            << " p99=" << std::setw(10) << percentile(99) / 1000.0
+            << " p99.9=" << std::setw(10) << percentile(99.9) / 1000.0
+            << " max=" << std::setw(10) << max() / 1000.0 << " мкс\n";
+    }
+
+    static size_t bucket_index(uint64_t value)
+    {
+        if (value < kSubBuckets)
+            return value;
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBits;
+        uint64_t sub = (value >> shift) - kSubBuckets;
+        return kSubBuckets + shift * kSubBuckets + sub;
+    }
+
+    static uint64_t bucket_upper(size_t index)
+    {
+        if (index < kSubBuckets)
+            return index;
+        int shift = (index - kSubBuckets) / kSubBuckets;
+        uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+        uint64_t low = (kSubBuckets + sub) << shift;
+        return low + ((1ull << shift) - 1);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> max_;
+};
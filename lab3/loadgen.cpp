@@ -0,0 +1,327 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <boost/program_options.hpp>
+#include "server.h"
+
+namespace po = boost::program_options;
+
+using gen_clock = std::chrono::steady_clock;
+
+struct Config {
+    size_t clients;
+    std::string mode;
+    double rate;
+    double duration;
+    size_t window;
+    std::string mix;
+    int cost;
+    bool typed;
+    size_t cache;
+    size_t capacity;
+    std::string policy;
+    int ttl_ms;
+    std::string metrics;
+    std::string metrics_format;
+    int metrics_interval_ms;
+    bool csv;
+};
+
+// Отказы при приёме, вытесненные задачи и результаты, удалённые по TTL
+// до сбора, увиденные клиентами.
+std::atomic<size_t> client_rejected{0};
+std::atomic<size_t> client_shed{0};
+std::atomic<size_t> client_expired{0};
+
+// Смесь задаётся как "sin:1,sqrt:1,pow:1" — веса операций.
+std::discrete_distribution<int> parse_mix(const std::string &mix)
+{
+    std::vector<double> weights(3, 0.0);
+    std::stringstream ss(mix);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        auto colon = item.find(':');
+        std::string name = item.substr(0, colon);
+        double weight = colon == std::string::npos ? 1.0 : std::stod(item.substr(colon + 1));
+        if (name == "sin")
+            weights[0] = weight;
+        else if (name == "sqrt")
+            weights[1] = weight;
+        else if (name == "pow")
+            weights[2] = weight;
+        else
+            throw std::invalid_argument("Неизвестная операция в смеси: " + name);
+    }
+    return std::discrete_distribution<int>(weights.begin(), weights.end());
+}
+
+// Генератор задач одного клиента. cost — сколько раз повторить операцию
+// внутри непрозрачной задачи, чтобы регулировать её стоимость.
+class TaskSource {
+public:
+    TaskSource(const Config &config, unsigned seed)
+        : config_(config), gen_(seed), mix_(parse_mix(config.mix)), dist_(0.1, 5.0) {}
+
+    // Для политик reject и shed используется неблокирующий try_add_*;
+    // пустой результат — задача не принята.
+    std::optional<size_t> submit(Server<double> &server)
+    {
+        const int type = mix_(gen_);
+        const double a = std::round(dist_(gen_) * 10) / 10.0;
+        const double b = std::round(dist_(gen_) * 10) / 10.0;
+        const Op op = type == 0 ? Op::Sin : (type == 1 ? Op::Sqrt : Op::Pow);
+        const bool blocking = config_.policy == "block";
+        if (config_.typed)
+            return blocking ? server.add_op(op, a, b) : server.try_add_op(op, a, b);
+        const int cost = config_.cost;
+        auto task = [op, a, b, cost]() {
+            double res = 0.0;
+            for (int i = 0; i < cost; ++i)
+            {
+                if (op == Op::Sin)
+                    res += fun_sin(a + i * 1e-9);
+                else if (op == Op::Sqrt)
+                    res += fun_sqrt(a + i * 1e-9);
+                else
+                    res += fun_pow(a, b + i * 1e-9);
+            }
+            return res;
+        };
+        return blocking ? server.add_task(task) : server.try_add_task(task);
+    }
+
+private:
+    const Config &config_;
+    std::mt19937 gen_;
+    std::discrete_distribution<int> mix_;
+    std::uniform_real_distribution<> dist_;
+};
+
+uint64_t elapsed_ns(gen_clock::time_point from, gen_clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+void collect(Server<double> &server, size_t id, gen_clock::time_point sent, LatencyHistogram &hist)
+{
+    try
+    {
+        server.request_result(id);
+        hist.record(elapsed_ns(sent, gen_clock::now()));
+    }
+    catch (const TaskShedError &)
+    {
+        client_shed++;
+    }
+    catch (const TaskExpiredError &)
+    {
+        client_expired++;
+    }
+}
+
+// Замкнутый цикл: у клиента всегда window задач в полёте, новая уходит
+// только после получения результата самой старой.
+void closed_loop_client(Server<double> &server, const Config &config, unsigned seed,
+                        gen_clock::time_point end, LatencyHistogram &hist)
+{
+    TaskSource source(config, seed);
+    std::deque<std::pair<size_t, gen_clock::time_point>> in_flight;
+    while (true)
+    {
+        const auto now = gen_clock::now();
+        while (now < end && in_flight.size() < config.window)
+        {
+            const auto sent = gen_clock::now();
+            auto id = source.submit(server);
+            if (!id)
+            {
+                client_rejected++;
+                break;
+            }
+            in_flight.push_back({*id, sent});
+        }
+        if (in_flight.empty())
+        {
+            if (gen_clock::now() >= end)
+                break;
+            continue;
+        }
+        auto [id, sent] = in_flight.front();
+        in_flight.pop_front();
+        collect(server, id, sent, hist);
+    }
+}
+
+// Открытый цикл: задачи уходят по расписанию независимо от ответов.
+// Задержка считается от запланированного момента отправки, поэтому
+// отставание отправителя не прячет очередь (coordinated omission).
+void open_loop_client(Server<double> &server, const Config &config, unsigned seed,
+                      gen_clock::time_point start, gen_clock::time_point end, LatencyHistogram &hist)
+{
+    TaskSource source(config, seed);
+    const auto interval = std::chrono::duration_cast<gen_clock::duration>(
+        std::chrono::duration<double>(config.clients / config.rate));
+
+    std::deque<std::pair<size_t, gen_clock::time_point>> in_flight;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+
+    std::thread collector([&]() {
+        while (true)
+        {
+            std::pair<size_t, gen_clock::time_point> item;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return !in_flight.empty() || done; });
+                if (in_flight.empty())
+                    return;
+                item = in_flight.front();
+                in_flight.pop_front();
+            }
+            collect(server, item.first, item.second, hist);
+        }
+    });
+
+    for (auto scheduled = start; scheduled < end; scheduled += interval)
+    {
+        std::this_thread::sleep_until(scheduled);
+        auto id = source.submit(server);
+        if (!id)
+        {
+            client_rejected++;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            in_flight.push_back({*id, scheduled});
+        }
+        cv.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+    }
+    cv.notify_one();
+    collector.join();
+}
+
+int main(int argc, char* argv[])
+{
+    Config config;
+
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("clients", po::value<size_t>(&config.clients)->default_value(3))
+    ("mode", po::value<std::string>(&config.mode)->default_value("closed"))
+    ("rate", po::value<double>(&config.rate)->default_value(100000))
+    ("duration", po::value<double>(&config.duration)->default_value(2.0))
+    ("window", po::value<size_t>(&config.window)->default_value(1))
+    ("mix", po::value<std::string>(&config.mix)->default_value("sin:1,sqrt:1,pow:1"))
+    ("cost", po::value<int>(&config.cost)->default_value(1))
+    ("typed", po::bool_switch(&config.typed))
+    ("cache", po::value<size_t>(&config.cache)->default_value(0))
+    ("capacity", po::value<size_t>(&config.capacity)->default_value(0))
+    ("policy", po::value<std::string>(&config.policy)->default_value("block"))
+    ("ttl_ms", po::value<int>(&config.ttl_ms)->default_value(0))
+    ("metrics", po::value<std::string>(&config.metrics)->default_value(""))
+    ("metrics_format", po::value<std::string>(&config.metrics_format)->default_value("prometheus"))
+    ("metrics_interval_ms", po::value<int>(&config.metrics_interval_ms)->default_value(1000))
+    ("csv", po::bool_switch(&config.csv));
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (config.mode != "closed" && config.mode != "open")
+    {
+        std::cerr << "Режим должен быть closed или open" << std::endl;
+        return 1;
+    }
+
+    ServerLimits limits;
+    limits.capacity = config.capacity;
+    limits.result_ttl = std::chrono::milliseconds(config.ttl_ms);
+    if (config.policy == "block")
+        limits.policy = OverflowPolicy::Block;
+    else if (config.policy == "reject")
+        limits.policy = OverflowPolicy::Reject;
+    else if (config.policy == "shed")
+        limits.policy = OverflowPolicy::Shed;
+    else
+    {
+        std::cerr << "Политика должна быть block, reject или shed" << std::endl;
+        return 1;
+    }
+
+    Server<double> server;
+    server.set_limits(limits);
+    if (config.cache)
+        server.enable_cache(config.cache);
+    if (!config.metrics.empty())
+        server.enable_metrics_dump(config.metrics, std::chrono::milliseconds(config.metrics_interval_ms),
+                                   config.metrics_format == "json" ? MetricsFormat::Json : MetricsFormat::Prometheus);
+    server.start();
+
+    std::vector<LatencyHistogram> hists(config.clients);
+    std::vector<std::thread> clients;
+    const auto start = gen_clock::now();
+    const auto end = start + std::chrono::duration_cast<gen_clock::duration>(
+        std::chrono::duration<double>(config.duration));
+    for (size_t c = 0; c < config.clients; ++c)
+    {
+        if (config.mode == "closed")
+            clients.emplace_back(closed_loop_client, std::ref(server), std::cref(config), c + 1, end,
+                                 std::ref(hists[c]));
+        else
+            clients.emplace_back(open_loop_client, std::ref(server), std::cref(config), c + 1, start, end,
+                                 std::ref(hists[c]));
+    }
+    for (auto &client : clients)
+        client.join();
+    const double elapsed = std::chrono::duration<double>(gen_clock::now() - start).count();
+    server.stop();
+
+    LatencyHistogram total;
+    for (auto &hist : hists)
+        total.merge(hist);
+    const double throughput = total.count() / elapsed;
+
+    if (config.csv)
+    {
+        std::cout << "mode,clients,rate,window,mix,cost,typed,capacity,policy,completed,rejected,shed,expired,"
+                     "throughput,p50_us,p99_us,p999_us,max_us\n";
+        std::cout << config.mode << "," << config.clients << "," << config.rate << "," << config.window << ",\""
+                  << config.mix << "\"," << config.cost << "," << config.typed << "," << config.capacity << ","
+                  << config.policy << "," << total.count() << "," << client_rejected << "," << client_shed << ","
+                  << client_expired << "," << throughput << "," << total.percentile(50) / 1000.0 << ","
+                  << total.percentile(99) / 1000.0 << "," << total.percentile(99.9) / 1000.0 << "," << total.max() / 1000.0 << "\n";
+        return 0;
+    }
+
+    std::cout << "Режим: " << config.mode << ", клиентов: " << config.clients;
+    if (config.mode == "open")
+        std::cout << ", частота: " << config.rate << " задач/с";
+    else
+        std::cout << ", окно: " << config.window;
+    std::cout << "\nСмесь: " << config.mix << ", стоимость: " << config.cost
+              << (config.typed ? ", типизированные" : "") << "\n";
+    if (config.capacity)
+        std::cout << "Ёмкость очереди: " << config.capacity << ", политика: " << config.policy << "\n";
+    std::cout << "Выполнено: " << total.count() << " задач за " << elapsed << " с, "
+              << throughput << " задач/с, отказов: " << client_rejected << ", вытеснено: " << client_shed
+              << ", просрочено: " << client_expired << "\n";
+    total.print(std::cout, "latency");
+    server.print_stats(std::cout);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "ops.h"
+
+// Кэш результатов чистых типизированных операций: ключ — код операции и
+// битовые образы аргументов. Разбит на шарды со своим мьютексом и своим
+// LRU, так что параллельные клиенты почти не конкурируют за блокировку.
+template<typename T>
+class MemoCache {
+public:
+    struct Key {
+        Op op;
+        T a;
+        T b;
+
+        bool operator==(const Key &other) const
+        {
+            return op == other.op && std::memcmp(&a, &other.a, sizeof(T)) == 0 &&
+                   std::memcmp(&b, &other.b, sizeof(T)) == 0;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const
+        {
+            uint64_t h = static_cast<uint64_t>(key.op) * 0x9e3779b97f4a7c15ull;
+            h ^= bits(key.a) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+            h ^= bits(key.b) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+
+        static uint64_t bits(const T &value)
+        {
+            uint64_t out = 0;
+            std::memcpy(&out, &value, std::min(sizeof(T), sizeof(out)));
+            return out;
+        }
+    };
+
+    explicit MemoCache(size_t capacity) : hits_(0), misses_(0)
+    {
+        for (auto &shard : shards_)
+            shard.capacity = std::max<size_t>(1, capacity / kShards);
+    }
+
+    bool lookup(const Key &key, T &value)
+    {
+        Shard &shard = shard_for(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end())
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                value = it->second->second;
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void insert(const Key &key, T value)
+    {
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+            return;
+        if (shard.lru.size() >= shard.capacity)
+        {
+            shard.index.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+        }
+        shard.lru.emplace_front(key, value);
+        shard.index[key] = shard.lru.begin();
+    }
+
+    size_t hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    size_t misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    double hit_rate() const
+    {
+        size_t total = hits() + misses();
+        return total ? static_cast<double>(hits()) / total : 0.0;
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::list<std::pair<Key, T>> lru;
+        std::unordered_map<Key, typename std::list<std::pair<Key, T>>::iterator, KeyHash> index;
+        size_t capacity = 1;
+    };
+
+    Shard &shard_for(const Key &key)
+    {
+        return shards_[(KeyHash{}(key) >> 7) % kShards];
+    }
+
+    std::array<Shard, kShards> shards_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+};
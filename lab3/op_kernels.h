@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include "ops.h"
+
+// Пакетное вычисление одной операции над массивами аргументов. Для double
+// на x86-64 с AVX2 используются векторные функции glibc (libmvec, точность
+// в пределах 4 ulp от скалярных), для остальных типов — скалярный цикл.
+
+template<typename T>
+void eval_batch_scalar(Op op, const T *a, const T *b, T *out, size_t n)
+{
+    switch (op)
+    {
+    case Op::Sin:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = fun_sin(a[i]);
+        break;
+    case Op::Sqrt:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = fun_sqrt(a[i]);
+        break;
+    case Op::Pow:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = fun_pow(a[i], b[i]);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename T>
+void eval_batch(Op op, const T *a, const T *b, T *out, size_t n)
+{
+    eval_batch_scalar(op, a, b, out, n);
+}
+
+#if defined(__x86_64__) && defined(__GLIBC__)
+#include <immintrin.h>
+
+extern "C" __m256d _ZGVdN4v_sin(__m256d);
+extern "C" __m256d _ZGVdN4vv_pow(__m256d, __m256d);
+
+__attribute__((target("avx2")))
+inline void eval_batch_avx2(Op op, const double *a, const double *b, double *out, size_t n)
+{
+    size_t i = 0;
+    switch (op)
+    {
+    case Op::Sin:
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(out + i, _ZGVdN4v_sin(_mm256_loadu_pd(a + i)));
+        break;
+    case Op::Sqrt:
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+        break;
+    case Op::Pow:
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(out + i, _ZGVdN4vv_pow(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        break;
+    default:
+        break;
+    }
+    eval_batch_scalar(op, a + i, b + i, out + i, n - i);
+}
+
+template<>
+inline void eval_batch<double>(Op op, const double *a, const double *b, double *out, size_t n)
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2)
+        eval_batch_avx2(op, a, b, out, n);
+    else
+        eval_batch_scalar(op, a, b, out, n);
+}
+#endif
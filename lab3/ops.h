@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cmath>
+
+template<typename T>
+T fun_sin(T arg)
+{
+    return std::sin(arg);
+}
+
+template<typename T>
+T fun_sqrt(T arg)
+{
+    return std::sqrt(arg);
+}
+
+template<typename T>
+T fun_pow(T base, T exponent)
+{
+    return std::pow(base, exponent);
+}
+
+// Типизированная операция: сервер видит код и аргументы и может собрать
+// одинаковые задачи из очереди в массив. Opaque — произвольная функция.
+enum class Op { Opaque, Sin, Sqrt, Pow };
+
+// Код операции из внешнего источника (int, uint32_t из shm) годится для
+// add_op, только если у неё есть пакетное ядро: Sin, Sqrt или Pow.
+template<typename Code>
+bool is_typed_op(Code code)
+{
+    return code >= static_cast<Code>(Op::Sin) && code <= static_cast<Code>(Op::Pow);
+}
+
+inline const char* op_name(Op op)
+{
+    static const char* names[] = {"opaque", "sin", "sqrt", "pow"};
+    return names[static_cast<int>(op)];
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ops.h"
+
+// Запись результата фиксированного размера — то, что клиент отдаёт в сток
+// вместо форматирования строки. Бинарный файл — просто массив таких записей.
+struct ResultRecord {
+    uint64_t id;
+    double a;
+    double b;
+    double result;
+    uint32_t op;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ResultRecord) == 40, "формат файла зависит от размера записи");
+
+enum class SinkFormat { Binary, Csv };
+
+// Асинхронный сток результатов. У каждого клиента свой канал: кольцевой
+// буфер с одним писателем и одним читателем без блокировок. Фоновый поток
+// забирает записи из всех каналов и пишет их в файлы крупными кусками.
+class ResultSink {
+public:
+    class Channel {
+    public:
+        Channel(const std::string &path, SinkFormat format) : format_(format)
+        {
+            file_ = std::fopen(path.c_str(), "wb");
+            if (!file_)
+                throw std::runtime_error("Не получилось открыть файл " + path);
+            std::setvbuf(file_, nullptr, _IONBF, 0);
+            if (format_ == SinkFormat::Csv)
+                out_ = "id,op,a,b,result\n";
+        }
+
+        ~Channel()
+        {
+            if (file_)
+                std::fclose(file_);
+        }
+
+        // Вызывается только потоком-владельцем канала. Если буфер полон,
+        // клиент ждёт писателя — это единственная обратная связь.
+        void push(const ResultRecord &record)
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            while (head - tail_cache_ >= kCapacity)
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head - tail_cache_ >= kCapacity)
+                    std::this_thread::yield();
+            }
+            ring_[head & (kCapacity - 1)] = record;
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+    private:
+        friend class ResultSink;
+
+        static constexpr size_t kCapacity = 1 << 14;
+        static constexpr size_t kFlushBytes = 1 << 20;
+
+        // Забирает всё накопленное; возвращает число записей.
+        size_t drain()
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t head = head_.load(std::memory_order_acquire);
+            for (size_t i = tail; i != head; ++i)
+                append(ring_[i & (kCapacity - 1)]);
+            tail_.store(head, std::memory_order_release);
+            if (out_.size() >= kFlushBytes)
+                flush();
+            return head - tail;
+        }
+
+        void append(const ResultRecord &record)
+        {
+            if (format_ == SinkFormat::Binary)
+            {
+                out_.append(reinterpret_cast<const char *>(&record), sizeof(record));
+                return;
+            }
+            char line[128];
+            char *p = line;
+            char *end = line + sizeof(line);
+            p = std::to_chars(p, end, record.id).ptr;
+            *p++ = ',';
+            const char *name = op_name(static_cast<Op>(record.op));
+            while (*name)
+                *p++ = *name++;
+            for (double value : {record.a, record.b, record.result})
+            {
+                *p++ = ',';
+                p = std::to_chars(p, end, value).ptr;
+            }
+            *p++ = '\n';
+            out_.append(line, p - line);
+        }
+
+        void flush()
+        {
+            if (!out_.empty())
+                std::fwrite(out_.data(), 1, out_.size(), file_);
+            out_.clear();
+        }
+
+        SinkFormat format_;
+        std::FILE *file_ = nullptr;
+        std::string out_;
+        std::unique_ptr<ResultRecord[]> ring_{new ResultRecord[kCapacity]};
+        size_t tail_cache_ = 0;
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+    };
+
+    explicit ResultSink(SinkFormat format = SinkFormat::Binary) : format_(format) {}
+
+    ~ResultSink()
+    {
+        close();
+    }
+
+    // Каналы открываются до start(): писатель обходит фиксированный список.
+    Channel &open(const std::string &path)
+    {
+        channels_.push_back(std::make_unique<Channel>(path, format_));
+        return *channels_.back();
+    }
+
+    void start()
+    {
+        running_ = true;
+        writer_ = std::thread(&ResultSink::writer_loop, this);
+    }
+
+    void close()
+    {
+        running_ = false;
+        if (writer_.joinable())
+            writer_.join();
+        for (auto &channel : channels_)
+        {
+            channel->drain();
+            channel->flush();
+        }
+    }
+
+private:
+    void writer_loop()
+    {
+        while (running_.load(std::memory_order_relaxed))
+        {
+            size_t drained = 0;
+            for (auto &channel : channels_)
+                drained += channel->drain();
+            if (drained == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    SinkFormat format_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    std::atomic<bool> running_{false};
+    std::thread writer_;
+};
@@ -0,0 +1,732 @@
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include "event_loop.h"
+#include "histogram.h"
+#include "ops.h"
+#include "op_kernels.h"
+#include "memo_cache.h"
+#include "server_metrics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Адаптивный спин перед сном: короткое ожидание убирает системный вызов,
+// если событие приходит через микросекунды. Бюджет растёт, когда спин
+// дождался события, и уменьшается, когда пришлось уснуть. На одном ядре
+// спин только отнимает процессор у того, кого ждём, поэтому он выключен.
+class SpinPolicy {
+public:
+    SpinPolicy() : limit_(std::thread::hardware_concurrency() > 1 ? kMaxSpin / 4 : 0) {}
+
+    template<typename Pred>
+    bool spin(Pred ready)
+    {
+        int limit = limit_.load(std::memory_order_relaxed);
+        if (limit == 0)
+            return ready();
+        for (int i = 0; i < limit; ++i)
+        {
+            if (ready())
+            {
+                limit_.store(std::min(limit * 2, kMaxSpin), std::memory_order_relaxed);
+                return true;
+            }
+            cpu_relax();
+        }
+        limit_.store(std::max(limit / 2, kMinSpin), std::memory_order_relaxed);
+        return ready();
+    }
+
+private:
+    static constexpr int kMinSpin = 16;
+    static constexpr int kMaxSpin = 4000;
+    std::atomic<int> limit_;
+};
+
+enum class Priority { High = 0, Normal = 1, Low = 2 };
+
+constexpr size_t kPriorityClasses = 3;
+
+inline const char* priority_name(Priority priority)
+{
+    static const char* names[] = {"high", "normal", "low"};
+    return names[static_cast<size_t>(priority)];
+}
+
+// deadline отсчитывается от момента постановки в очередь; ноль — без срока.
+struct TaskOptions {
+    Priority priority = Priority::Normal;
+    std::chrono::microseconds deadline{0};
+};
+
+enum class OverflowPolicy { Block, Reject, Shed };
+
+// capacity — сколько задач может ждать в очереди (0 — без ограничения).
+// При переполнении Block усыпляет отправителя, Reject сразу отказывает,
+// Shed вытесняет самую свежую задачу более низкого класса, а если такой
+// нет — отказывает. try_add_* никогда не блокируются.
+// result_ttl — сколько хранится несобранный результат (0 — бессрочно);
+// request_result по удалённому бросает TaskExpiredError.
+struct ServerLimits {
+    size_t capacity = 0;
+    OverflowPolicy policy = OverflowPolicy::Block;
+    std::chrono::milliseconds result_ttl{0};
+};
+
+class QueueFullError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class TaskShedError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Результат готов, но удалён по result_ttl раньше, чем его забрали.
+class TaskExpiredError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+template<typename T>
+class Server {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Job {
+        Op op;
+        std::function<T()> fn;
+        T a{};
+        T b{};
+    };
+
+    // Каждый aging ожидания поднимает голову очереди на один класс, так что
+    // low обгоняет свежие high-задачи не позже чем через 3 * aging.
+    // Задача, до срока которой осталось меньше urgency, обслуживается первой.
+    explicit Server(std::chrono::microseconds aging = std::chrono::milliseconds(10),
+                    std::chrono::microseconds urgency = std::chrono::microseconds(200))
+        : running_(false), stopped_(false), idle_(false), blocked_(0), task_counter_(0), pending_(0),
+          aging_(aging), urgency_(urgency), deadline_misses_(0),
+          peak_depth_(0), rejected_(0), shed_(0), expired_(0) {}
+
+    void start()
+    {
+        running_ = true;
+        server_thread_ = std::thread(&Server::server_loop, this);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            running_ = false;
+            stopped_ = true;
+        }
+        cv_.notify_all();
+        space_cv_.notify_all();
+        if (server_thread_.joinable())
+            server_thread_.join();
+        metrics_.stop_dump();
+    }
+
+    // Периодически переписывает path снимком метрик жизненного цикла задач.
+    // Последний снимок пишется в stop().
+    void enable_metrics_dump(const std::string &path, std::chrono::milliseconds interval,
+                             MetricsFormat format = MetricsFormat::Prometheus)
+    {
+        metrics_.start_dump(path, interval, format, [this]() { return queue_depth(); });
+    }
+
+    size_t add_task(std::function<T()> task, TaskOptions options = {})
+    {
+        return accepted(enqueue(Job{Op::Opaque, std::move(task)}, options, std::make_shared<Slot>(), nullptr, true));
+    }
+
+    std::optional<size_t> try_add_task(std::function<T()> task, TaskOptions options = {})
+    {
+        return optional_id(enqueue(Job{Op::Opaque, std::move(task)}, options, std::make_shared<Slot>(), nullptr, false));
+    }
+
+    // Типизированная задача: сервер вычисляет её пакетом вместе с другими
+    // задачами той же операции из очереди. b нужен только для pow.
+    size_t add_op(Op op, T a, T b = T{}, TaskOptions options = {})
+    {
+        require_typed(op);
+        if (op != Op::Pow)
+            b = T{};
+        T cached;
+        if (cache_ && cache_->lookup({op, a, b}, cached))
+            return add_ready(cached);
+        return accepted(enqueue(Job{op, nullptr, a, b}, options, std::make_shared<Slot>(), nullptr, true));
+    }
+
+    std::optional<size_t> try_add_op(Op op, T a, T b = T{}, TaskOptions options = {})
+    {
+        require_typed(op);
+        if (op != Op::Pow)
+            b = T{};
+        T cached;
+        if (cache_ && cache_->lookup({op, a, b}, cached))
+            return add_ready(cached);
+        return optional_id(enqueue(Job{op, nullptr, a, b}, options, std::make_shared<Slot>(), nullptr, false));
+    }
+
+    // Типизированная задача с обратным вызовом вместо id: on_done(value, shed)
+    // зовётся потоком сервера, а при попадании в кэш — сразу здесь.
+    // false — задача отклонена политикой переполнения.
+    bool add_op_async(Op op, T a, T b, std::function<void(T, bool)> on_done, TaskOptions options = {})
+    {
+        require_typed(op);
+        if (op != Op::Pow)
+            b = T{};
+        T cached;
+        if (cache_ && cache_->lookup({op, a, b}, cached))
+        {
+            on_done(cached, false);
+            return true;
+        }
+        return enqueue(Job{op, nullptr, a, b}, options, nullptr, std::move(on_done), true) != 0;
+    }
+
+    // Вызывать до start().
+    void set_limits(ServerLimits limits)
+    {
+        limits_ = limits;
+    }
+
+    // Включает кэш результатов типизированных операций (они чистые по
+    // построению). Вызывать до start(); попадание завершает задачу сразу
+    // в add_op/submit_op, не трогая очередь сервера.
+    void enable_cache(size_t capacity)
+    {
+        cache_ = std::make_unique<MemoCache<T>>(capacity);
+    }
+
+    const MemoCache<T>* cache() const
+    {
+        return cache_.get();
+    }
+
+    // co_await server.submit(f) внутри корутины EventLoop: результат приходит
+    // через путь завершения задачи, без id и без блокировки потока клиента.
+    class SubmitAwaiter {
+    public:
+        SubmitAwaiter(Server &server, Job job, TaskOptions options)
+            : server_(server), job_(std::move(job)), options_(options) {}
+
+        bool await_ready() noexcept
+        {
+            return job_.op != Op::Opaque && server_.cache_ &&
+                   server_.cache_->lookup({job_.op, job_.a, job_.b}, value_);
+        }
+
+        // При политике Block переполненная очередь блокирует поток цикла.
+        // Отказ не приостанавливает корутину: await_resume бросит исключение.
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            EventLoop *loop = EventLoop::current();
+            size_t id = server_.enqueue(std::move(job_), options_, nullptr, [this, loop, handle](T value, bool shed) {
+                value_ = value;
+                shed_ = shed;
+                if (loop)
+                    loop->post(handle);
+                else
+                    handle.resume();
+            }, true);
+            if (id == 0)
+            {
+                rejected_ = true;
+                return false;
+            }
+            return true;
+        }
+
+        T await_resume() const
+        {
+            if (rejected_)
+                throw QueueFullError("Очередь сервера заполнена");
+            if (shed_)
+                throw TaskShedError("Задача вытеснена из очереди");
+            return value_;
+        }
+
+    private:
+        Server &server_;
+        Job job_;
+        TaskOptions options_;
+        T value_{};
+        bool rejected_ = false;
+        bool shed_ = false;
+    };
+
+    SubmitAwaiter submit(std::function<T()> task, TaskOptions options = {})
+    {
+        return SubmitAwaiter(*this, Job{Op::Opaque, std::move(task)}, options);
+    }
+
+    SubmitAwaiter submit_op(Op op, T a, T b = T{}, TaskOptions options = {})
+    {
+        require_typed(op);
+        if (op != Op::Pow)
+            b = T{};
+        return SubmitAwaiter(*this, Job{op, nullptr, a, b}, options);
+    }
+
+    T request_result(size_t id)
+    {
+        std::shared_ptr<Slot> slot;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = slots_.find(id);
+            if (it == slots_.end())
+            {
+                if (expired_ids_.erase(id))
+                    throw TaskExpiredError("Результат задачи " + std::to_string(id) + " удалён по сроку хранения");
+                throw std::out_of_range("Неизвестный id задачи: " + std::to_string(id));
+            }
+            slot = it->second;
+        }
+
+        client_spin_.spin([&]() { return slot->ready.load(std::memory_order_acquire); });
+        // atomic::wait паркует поток на futex этого слота, поэтому
+        // завершение задачи будит только её ожидающего.
+        while (!slot->ready.load(std::memory_order_acquire))
+            slot->ready.wait(false, std::memory_order_acquire);
+
+        T res = slot->value;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            slots_.erase(id);
+        }
+        metrics_.record_collection(slot->done, ServerMetrics::stamp());
+        if (slot->shed)
+            throw TaskShedError("Задача " + std::to_string(id) + " вытеснена из очереди");
+        return res;
+    }
+
+    // Время от постановки в очередь до готовности результата, в наносекундах.
+    const LatencyHistogram& class_latency(Priority priority) const
+    {
+        return class_latency_[static_cast<size_t>(priority)];
+    }
+
+    size_t deadline_misses() const
+    {
+        return deadline_misses_.load(std::memory_order_relaxed);
+    }
+
+    size_t queue_depth() const
+    {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+    size_t peak_queue_depth() const
+    {
+        return peak_depth_.load(std::memory_order_relaxed);
+    }
+
+    size_t rejected() const
+    {
+        return rejected_.load(std::memory_order_relaxed);
+    }
+
+    size_t shed() const
+    {
+        return shed_.load(std::memory_order_relaxed);
+    }
+
+    size_t expired() const
+    {
+        return expired_.load(std::memory_order_relaxed);
+    }
+
+    void print_stats(std::ostream &out) const
+    {
+        for (size_t c = 0; c < kPriorityClasses; ++c)
+            class_latency_[c].print(out, priority_name(static_cast<Priority>(c)));
+        out << "Пропущено сроков: " << deadline_misses() << "\n";
+        out << "Очередь: сейчас " << queue_depth() << ", пик " << peak_queue_depth()
+            << ", отказов " << rejected() << ", вытеснено " << shed()
+            << ", просрочено результатов " << expired() << "\n";
+    }
+
+private:
+    // У Opaque и кодов вне Op нет пакетного ядра, а fn типизированной
+    // задачи пуст: поток сервера вызвал бы пустую функцию.
+    static void require_typed(Op op)
+    {
+        if (!is_typed_op(static_cast<int>(op)))
+            throw std::invalid_argument("Операция без пакетного ядра: " + std::to_string(static_cast<int>(op)));
+    }
+
+    struct Slot {
+        std::atomic<bool> ready{false};
+        bool shed = false;
+        T value{};
+        clock::time_point done;
+    };
+
+    struct Task {
+        size_t id;
+        Job job;
+        std::shared_ptr<Slot> slot;
+        std::function<void(T, bool)> on_done;
+        Priority priority;
+        clock::time_point enqueued;
+        clock::time_point deadline;
+    };
+
+    std::array<std::deque<Task>, kPriorityClasses> tasks_;
+    std::unordered_map<size_t, std::shared_ptr<Slot>> slots_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable space_cv_;
+    bool running_;
+    bool stopped_;
+    bool idle_;
+    size_t blocked_;
+    size_t task_counter_;
+    std::atomic<size_t> pending_;
+    std::chrono::microseconds aging_;
+    std::chrono::microseconds urgency_;
+    std::array<LatencyHistogram, kPriorityClasses> class_latency_;
+    std::atomic<size_t> deadline_misses_;
+    SpinPolicy server_spin_;
+    SpinPolicy client_spin_;
+    std::unique_ptr<MemoCache<T>> cache_;
+    ServerLimits limits_;
+    std::atomic<size_t> peak_depth_;
+    std::atomic<size_t> rejected_;
+    std::atomic<size_t> shed_;
+    std::atomic<size_t> expired_;
+    // Готовые слоты в порядке завершения — для удаления несобранных по TTL.
+    std::deque<std::pair<size_t, clock::time_point>> completed_;
+    // Id последних kExpiredMemory удалённых по TTL результатов: по ним
+    // request_result бросает TaskExpiredError, а не out_of_range.
+    static constexpr size_t kExpiredMemory = 65536;
+    std::unordered_set<size_t> expired_ids_;
+    std::deque<size_t> expired_order_;
+    ServerMetrics metrics_;
+    std::thread server_thread_;
+
+    static size_t accepted(size_t id)
+    {
+        if (id == 0)
+            throw QueueFullError("Очередь сервера заполнена");
+        return id;
+    }
+
+    static std::optional<size_t> optional_id(size_t id)
+    {
+        if (id == 0)
+            return std::nullopt;
+        return id;
+    }
+
+    // Освобождает место в полной очереди по политике. Вытесненная задача
+    // возвращается через victim и завершается вызывающим после unlock.
+    bool make_room(Priority priority, std::unique_lock<std::mutex> &lock, bool may_block,
+                   std::optional<Task> &victim)
+    {
+        if (limits_.policy == OverflowPolicy::Block && may_block)
+        {
+            blocked_++;
+            space_cv_.wait(lock, [&]() { return pending_.load(std::memory_order_relaxed) < limits_.capacity || stopped_; });
+            blocked_--;
+            return pending_.load(std::memory_order_relaxed) < limits_.capacity;
+        }
+        if (limits_.policy == OverflowPolicy::Shed)
+        {
+            for (size_t c = kPriorityClasses; c-- > static_cast<size_t>(priority) + 1;)
+            {
+                if (tasks_[c].empty())
+                    continue;
+                victim.emplace(std::move(tasks_[c].back()));
+                tasks_[c].pop_back();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                shed_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Задача с slot ждёт request_result по id, задача с on_done отдаёт
+    // результат обратным вызовом и в slots_ не попадает. Возвращает 0,
+    // если очередь полна и политика не позволила освободить место.
+    size_t enqueue(Job job, TaskOptions options, std::shared_ptr<Slot> slot,
+                   std::function<void(T, bool)> on_done, bool may_block)
+    {
+        const auto now = clock::now();
+        const auto deadline = options.deadline.count() > 0 ? now + options.deadline : clock::time_point::max();
+        std::optional<Task> victim;
+        size_t id;
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (limits_.capacity && pending_.load(std::memory_order_relaxed) >= limits_.capacity &&
+                !make_room(options.priority, lock, may_block, victim))
+            {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return 0;
+            }
+            id = ++task_counter_;
+            if (slot)
+                slots_[id] = slot;
+            tasks_[static_cast<size_t>(options.priority)].push_back(
+                {id, std::move(job), std::move(slot), std::move(on_done), options.priority, now, deadline});
+            size_t depth = pending_.fetch_add(1, std::memory_order_release) + 1;
+            if (depth > peak_depth_.load(std::memory_order_relaxed))
+                peak_depth_.store(depth, std::memory_order_relaxed);
+            wake = idle_;
+        }
+        if (wake)
+            cv_.notify_one();
+        if (victim)
+            shed_task(*victim);
+        return id;
+    }
+
+    size_t add_ready(T value)
+    {
+        auto slot = std::make_shared<Slot>();
+        slot->value = value;
+        slot->done = clock::now();
+        slot->ready.store(true, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t id = ++task_counter_;
+        slots_[id] = std::move(slot);
+        if (limits_.result_ttl.count() > 0)
+            completed_.push_back({id, clock::now()});
+        return id;
+    }
+
+    // Удаляет результаты, которые никто не забрал за result_ttl.
+    // Вызывается под mtx_.
+    void expire_results(clock::time_point now)
+    {
+        while (!completed_.empty() && now - completed_.front().second >= limits_.result_ttl)
+        {
+            const size_t id = completed_.front().first;
+            completed_.pop_front();
+            if (!slots_.erase(id))
+                continue;
+            expired_.fetch_add(1, std::memory_order_relaxed);
+            expired_ids_.insert(id);
+            expired_order_.push_back(id);
+            if (expired_order_.size() > kExpiredMemory)
+            {
+                expired_ids_.erase(expired_order_.front());
+                expired_order_.pop_front();
+            }
+        }
+    }
+
+    bool has_tasks() const
+    {
+        return pending_.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Выбирает класс по голове каждой очереди: ранг = класс минус число
+    // прожитых интервалов aging, срочные по deadline идут раньше всех.
+    // При равенстве рангов побеждает более высокий класс.
+    size_t pick_class(clock::time_point now) const
+    {
+        size_t best = kPriorityClasses;
+        long best_rank = std::numeric_limits<long>::max();
+        for (size_t c = 0; c < kPriorityClasses; ++c)
+        {
+            if (tasks_[c].empty())
+                continue;
+            const Task &head = tasks_[c].front();
+            long rank;
+            if (head.deadline != clock::time_point::max() && head.deadline - now < urgency_)
+                rank = std::numeric_limits<long>::min();
+            else
+                rank = static_cast<long>(c) - static_cast<long>((now - head.enqueued) / aging_);
+            if (rank < best_rank)
+            {
+                best = c;
+                best_rank = rank;
+            }
+        }
+        return best;
+    }
+
+    // Если голова — типизированная операция, забирает из первых kBatchWindow
+    // задач того же класса все задачи этой операции (до kMaxBatch), не меняя
+    // порядок остальных.
+    static constexpr size_t kBatchWindow = 1024;
+    static constexpr size_t kMaxBatch = 256;
+
+    bool pop_batch(std::vector<Task> &batch)
+    {
+        server_spin_.spin([&]() { return pending_.load(std::memory_order_acquire) != 0; });
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        idle_ = true;
+        if (limits_.result_ttl.count() > 0)
+        {
+            // Простаивающий сервер тоже чистит просроченные результаты:
+            // просыпается к сроку самого старого или раз в result_ttl.
+            while (!has_tasks() && running_)
+            {
+                const auto now = clock::now();
+                expire_results(now);
+                const auto wake = completed_.empty() ? now + limits_.result_ttl
+                                                     : completed_.front().second + limits_.result_ttl;
+                cv_.wait_until(lock, wake);
+            }
+        }
+        else
+            cv_.wait(lock, [&]() { return has_tasks() || !running_; });
+        idle_ = false;
+        if (!has_tasks())
+            return false;
+        auto &queue = tasks_[pick_class(clock::now())];
+        const Op op = queue.front().job.op;
+        if (op == Op::Opaque)
+        {
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        else
+        {
+            const size_t window = std::min(queue.size(), kBatchWindow);
+            size_t keep = 0;
+            for (size_t i = 0; i < window; ++i)
+            {
+                if (queue[i].job.op == op && batch.size() < kMaxBatch)
+                    batch.push_back(std::move(queue[i]));
+                else
+                {
+                    if (keep != i)
+                        queue[keep] = std::move(queue[i]);
+                    keep++;
+                }
+            }
+            queue.erase(queue.begin() + keep, queue.begin() + window);
+        }
+        pending_.fetch_sub(batch.size(), std::memory_order_relaxed);
+        if (blocked_)
+            space_cv_.notify_all();
+        return true;
+    }
+
+    static void complete(Slot &slot, T value, clock::time_point done)
+    {
+        slot.value = value;
+        slot.done = done;
+        slot.ready.store(true, std::memory_order_release);
+        slot.ready.notify_one();
+    }
+
+    static void shed_task(Task &task)
+    {
+        if (task.on_done)
+        {
+            task.on_done(T{}, true);
+            return;
+        }
+        task.slot->shed = true;
+        complete(*task.slot, T{}, clock::now());
+    }
+
+    void finish(Task &task, T res, clock::time_point done)
+    {
+        class_latency_[static_cast<size_t>(task.priority)].record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(done - task.enqueued).count());
+        if (done > task.deadline)
+            deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+        if (task.on_done)
+            task.on_done(res, false);
+        else
+            complete(*task.slot, res, done);
+    }
+
+    // Ставит завершённые слоты пакета на учёт для TTL и чистит просроченные.
+    void track_completed(const std::vector<Task> &batch, clock::time_point done)
+    {
+        if (limits_.result_ttl.count() == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const Task &task : batch)
+            if (task.slot)
+                completed_.push_back({task.id, done});
+        expire_results(done);
+    }
+
+    void server_loop()
+    {
+        std::vector<Task> batch;
+        std::vector<T> args_a, args_b, results;
+        while (pop_batch(batch))
+        {
+            const auto dequeued = ServerMetrics::stamp();
+            for (const Task &task : batch)
+                metrics_.record_queue_wait(task.enqueued, dequeued);
+            clock::time_point done;
+            if (batch.front().job.op == Op::Opaque)
+            {
+                T res = batch.front().job.fn();
+                done = clock::now();
+                finish(batch.front(), res, done);
+            }
+            else
+            {
+                const size_t n = batch.size();
+                args_a.resize(n);
+                args_b.resize(n);
+                results.resize(n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    args_a[i] = batch[i].job.a;
+                    args_b[i] = batch[i].job.b;
+                }
+                const Op op = batch.front().job.op;
+                eval_batch(op, args_a.data(), args_b.data(), results.data(), n);
+                if (cache_)
+                    for (size_t i = 0; i < n; ++i)
+                        cache_->insert({op, args_a[i], args_b[i]}, results[i]);
+                done = clock::now();
+                for (size_t i = 0; i < n; ++i)
+                    finish(batch[i], results[i], done);
+            }
+            metrics_.record_execution(dequeued, done, batch.size());
+            track_completed(batch, done);
+            batch.clear();
+        }
+        std::cout << "Сервер остановлен." << std::endl;
+    }
+};
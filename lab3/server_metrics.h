@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "histogram.h"
+
+enum class MetricsFormat { Prometheus, Json };
+
+// Жизненный цикл задачи: постановка в очередь -> извлечение сервером ->
+// завершение -> получение клиентом. Гистограммы разбиты на шарды по потокам,
+// запись — relaxed-атомики без блокировок. Сборка с -DSERVER_NO_METRICS
+// заменяет всё пустыми inline-функциями, включая чтения часов.
+#ifndef SERVER_NO_METRICS
+
+class ServerMetrics {
+public:
+    using clock = std::chrono::steady_clock;
+
+    ServerMetrics() : created_(clock::now()) {}
+
+    ~ServerMetrics()
+    {
+        stop_dump();
+    }
+
+    static clock::time_point stamp()
+    {
+        return clock::now();
+    }
+
+    void record_queue_wait(clock::time_point enqueued, clock::time_point dequeued)
+    {
+        shard().queue_wait.record(ns(dequeued - enqueued));
+    }
+
+    // Время выполнения пакета делится поровну между его задачами.
+    void record_execution(clock::time_point dequeued, clock::time_point done, size_t tasks)
+    {
+        const uint64_t busy = ns(done - dequeued);
+        Shard &s = shard();
+        for (size_t i = 0; i < tasks; ++i)
+            s.execution.record(busy / tasks);
+        busy_ns_.fetch_add(busy, std::memory_order_relaxed);
+        completed_.fetch_add(tasks, std::memory_order_relaxed);
+    }
+
+    void record_collection(clock::time_point done, clock::time_point collected)
+    {
+        shard().collection_wait.record(ns(collected - done));
+        collected_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Запускает поток, который раз в interval переписывает файл path.
+    // depth — текущая глубина очереди сервера.
+    void start_dump(const std::string &path, std::chrono::milliseconds interval, MetricsFormat format,
+                    std::function<size_t()> depth)
+    {
+        stop_dump();
+        dumping_ = true;
+        dumper_ = std::thread([this, path, interval, format, depth]() {
+            std::unique_lock<std::mutex> lock(dump_mtx_);
+            while (dumping_)
+            {
+                dump_cv_.wait_for(lock, interval, [&]() { return !dumping_; });
+                write(path, format, depth());
+            }
+        });
+    }
+
+    void stop_dump()
+    {
+        {
+            std::lock_guard<std::mutex> lock(dump_mtx_);
+            dumping_ = false;
+        }
+        dump_cv_.notify_all();
+        if (dumper_.joinable())
+            dumper_.join();
+    }
+
+    // Пишет во временный файл и переименовывает, чтобы читатель никогда
+    // не увидел половину снимка.
+    void write(const std::string &path, MetricsFormat format, size_t depth) const
+    {
+        LatencyHistogram queue_wait, execution, collection_wait;
+        for (const Shard &s : shards_)
+        {
+            queue_wait.merge(s.queue_wait);
+            execution.merge(s.execution);
+            collection_wait.merge(s.collection_wait);
+        }
+        const double uptime = std::chrono::duration<double>(clock::now() - created_).count();
+        const size_t completed = completed_.load(std::memory_order_relaxed);
+        const double utilization = busy_ns_.load(std::memory_order_relaxed) / 1e9 / uptime;
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp);
+            if (format == MetricsFormat::Prometheus)
+            {
+                out << "# TYPE server_tasks_completed_total counter\n"
+                    << "server_tasks_completed_total " << completed << "\n"
+                    << "# TYPE server_results_collected_total counter\n"
+                    << "server_results_collected_total " << collected_.load(std::memory_order_relaxed) << "\n"
+                    << "# TYPE server_queue_depth gauge\n"
+                    << "server_queue_depth " << depth << "\n"
+                    << "# TYPE server_tasks_per_second gauge\n"
+                    << "server_tasks_per_second " << completed / uptime << "\n"
+                    << "# TYPE server_worker_utilization gauge\n"
+                    << "server_worker_utilization " << utilization << "\n";
+                prometheus_summary(out, "server_queue_wait_seconds", queue_wait);
+                prometheus_summary(out, "server_execution_seconds", execution);
+                prometheus_summary(out, "server_collection_wait_seconds", collection_wait);
+            }
+            else
+            {
+                out << "{\"tasks_completed\": " << completed
+                    << ", \"results_collected\": " << collected_.load(std::memory_order_relaxed)
+                    << ", \"queue_depth\": " << depth
+                    << ", \"tasks_per_second\": " << completed / uptime
+                    << ", \"worker_utilization\": " << utilization;
+                json_summary(out, "queue_wait_us", queue_wait);
+                json_summary(out, "execution_us", execution);
+                json_summary(out, "collection_wait_us", collection_wait);
+                out << "}\n";
+            }
+        }
+        std::rename(tmp.c_str(), path.c_str());
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct alignas(64) Shard {
+        LatencyHistogram queue_wait;
+        LatencyHistogram execution;
+        LatencyHistogram collection_wait;
+    };
+
+    static uint64_t ns(clock::duration d)
+    {
+        return d.count() > 0 ? std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() : 0;
+    }
+
+    // Каждый поток получает свой шард при первой записи.
+    Shard &shard()
+    {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return shards_[index];
+    }
+
+    static void prometheus_summary(std::ostream &out, const char *name, const LatencyHistogram &h)
+    {
+        out << "# TYPE " << name << " summary\n";
+        for (double q : {0.5, 0.99, 0.999})
+            out << name << "{quantile=\"" << q << "\"} " << h.percentile(q * 100) / 1e9 << "\n";
+        out << name << "_count " << h.count() << "\n";
+    }
+
+    static void json_summary(std::ostream &out, const char *name, const LatencyHistogram &h)
+    {
+        out << ", \"" << name << "\": {\"count\": " << h.count()
+            << ", \"p50\": " << h.percentile(50) / 1000.0
+            << ", \"p99\": " << h.percentile(99) / 1000.0
+            << ", \"p999\": " << h.percentile(99.9) / 1000.0
+            << ", \"max\": " << h.max() / 1000.0 << "}";
+    }
+
+    std::array<Shard, kShards> shards_;
+    std::atomic<uint64_t> busy_ns_{0};
+    std::atomic<size_t> completed_{0};
+    std::atomic<size_t> collected_{0};
+    clock::time_point created_;
+
+    std::thread dumper_;
+    std::mutex dump_mtx_;
+    std::condition_variable dump_cv_;
+    bool dumping_ = false;
+};
+
+#else
+
+class ServerMetrics {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static clock::time_point stamp() { return {}; }
+    void record_queue_wait(clock::time_point, clock::time_point) {}
+    void record_execution(clock::time_point, clock::time_point, size_t) {}
+    void record_collection(clock::time_point, clock::time_point) {}
+    void start_dump(const std::string &, std::chrono::milliseconds, MetricsFormat, std::function<size_t()>) {}
+    void stop_dump() {}
+    void write(const std::string &, MetricsFormat, size_t) const {}
+};
+
+#endif
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <string>
+#include <cmath>
+#include <boost/program_options.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "server.h"
+#include "shm_transport.h"
+
+namespace po = boost::program_options;
+
+using bench_clock = std::chrono::steady_clock;
+
+// Сравнение клиента в том же процессе (add_op/request_result) с клиентом
+// из другого процесса через shm_transport.h. Нагрузка одинаковая: sin, sqrt
+// и pow по очереди, аргументы из 50 значений.
+
+double percentile(std::vector<double> &samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+    size_t k = static_cast<size_t>(p / 100.0 * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+struct Request {
+    Op op;
+    double a;
+    double b;
+};
+
+Request make_request(size_t i)
+{
+    static const Op ops[] = {Op::Sin, Op::Sqrt, Op::Pow};
+    Op op = ops[i % 3];
+    double a = 0.1 + (i % 50) / 10.0;
+    return {op, a, op == Op::Pow ? 0.1 + (i % 7) / 10.0 : 0.0};
+}
+
+double expected(const Request &r)
+{
+    if (r.op == Op::Sin)
+        return fun_sin(r.a);
+    if (r.op == Op::Sqrt)
+        return fun_sqrt(r.a);
+    return fun_pow(r.a, r.b);
+}
+
+// Пакетные ядра libmvec отличаются от скалярных в последних битах.
+bool wrong(double res, const Request &r)
+{
+    const double e = expected(r);
+    return std::fabs(res - e) > 1e-12 * std::max(1.0, std::fabs(e));
+}
+
+void report(const char *name, std::vector<double> &latencies, double throughput, size_t window, size_t errors)
+{
+    std::cout << name << ": p50 " << percentile(latencies, 50) << " мкс, p99 " << percentile(latencies, 99)
+              << " мкс; окно " << window << ": " << throughput << " задач/с";
+    if (errors)
+        std::cout << ", неверных результатов: " << errors;
+    std::cout << "\n";
+}
+
+void bench_in_process(size_t requests, size_t tasks, size_t window)
+{
+    Server<double> server;
+    server.start();
+
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    size_t errors = 0;
+    for (size_t i = 0; i < requests; ++i)
+    {
+        Request r = make_request(i);
+        const auto start{bench_clock::now()};
+        double res = server.request_result(server.add_op(r.op, r.a, r.b));
+        latencies.push_back(std::chrono::duration<double, std::micro>(bench_clock::now() - start).count());
+        errors += wrong(res, r);
+    }
+
+    std::deque<size_t> ids;
+    const auto start{bench_clock::now()};
+    for (size_t i = 0; i < tasks; ++i)
+    {
+        if (ids.size() == window)
+        {
+            errors += wrong(server.request_result(ids.front()), make_request(i - window));
+            ids.pop_front();
+        }
+        Request r = make_request(i);
+        ids.push_back(server.add_op(r.op, r.a, r.b));
+    }
+    for (size_t k = 0; k < ids.size(); ++k)
+        errors += wrong(server.request_result(ids[k]), make_request(tasks - ids.size() + k));
+    const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+    server.stop();
+
+    report("В процессе", latencies, tasks / elapsed, window, errors);
+}
+
+// Тег заявки — её номер, поэтому ответ проверяется без отдельной таблицы.
+void bench_shm_client(const std::string &name, size_t requests, size_t tasks, size_t window)
+{
+    std::unique_ptr<ShmClient> client;
+    for (int attempt = 0; !client; ++attempt)
+    {
+        try
+        {
+            client = std::make_unique<ShmClient>(name);
+        }
+        catch (const std::runtime_error &)
+        {
+            if (attempt == 5000)
+                throw;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    size_t errors = 0;
+    for (size_t i = 0; i < requests; ++i)
+    {
+        Request r = make_request(i);
+        const auto start{bench_clock::now()};
+        double res = client->call(r.op, r.a, r.b);
+        latencies.push_back(std::chrono::duration<double, std::micro>(bench_clock::now() - start).count());
+        errors += wrong(res, r);
+    }
+
+    window = std::min(window, kShmCompleteSlots);
+    std::vector<Request> sent(tasks);
+    auto settle = [&](const ShmCompletion &done) {
+        errors += done.status != kShmOk || wrong(done.result, sent[done.tag - requests - 1]);
+    };
+    const auto start{bench_clock::now()};
+    for (size_t i = 0; i < tasks; ++i)
+    {
+        if (client->outstanding() == window)
+            settle(client->wait());
+        sent[i] = make_request(i);
+        client->submit(sent[i].op, sent[i].a, sent[i].b);
+    }
+    while (client->outstanding())
+        settle(client->wait());
+    const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    report("Другой процесс (shm)", latencies, tasks / elapsed, window, errors);
+}
+
+// Сервер с фронтендом живёт, пока не завершится клиент-потомок
+// (role=both) или не истечёт duration (role=server).
+int main(int argc, char* argv[])
+{
+    std::string role = "both";
+    std::string name = "/lab3_server";
+    size_t requests = 20000;
+    size_t tasks = 1000000;
+    size_t window = 64;
+    size_t cache = 0;
+    int duration = 10;
+
+    po::options_description desc("Параметры");
+    desc.add_options()
+        ("role", po::value<std::string>(&role)->default_value("both"), "both | server | client")
+        ("name", po::value<std::string>(&name)->default_value("/lab3_server"), "имя сегмента shm")
+        ("requests", po::value<size_t>(&requests)->default_value(20000), "синхронных вызовов для задержки")
+        ("tasks", po::value<size_t>(&tasks)->default_value(1000000), "задач для пропускной способности")
+        ("window", po::value<size_t>(&window)->default_value(64), "заявок в полёте")
+        ("cache", po::value<size_t>(&cache)->default_value(0), "ёмкость кэша сервера, 0 — без кэша")
+        ("duration", po::value<int>(&duration)->default_value(10), "секунд работы для role=server");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (role == "client")
+    {
+        bench_shm_client(name, requests, tasks, window);
+        return 0;
+    }
+    if (role == "both")
+        bench_in_process(requests, tasks, window);
+
+    // Сегмент создаётся и fork делается до запуска потоков сервера.
+    Server<double> server;
+    if (cache)
+        server.enable_cache(cache);
+    ShmFrontend frontend(server, name);
+
+    pid_t child = -1;
+    if (role == "both")
+    {
+        std::cout.flush();
+        child = fork();
+        if (child == 0)
+        {
+            bench_shm_client(name, requests, tasks, window);
+            std::cout.flush();
+            _exit(0);
+        }
+    }
+
+    server.start();
+    frontend.start();
+    int status = 0;
+    if (child > 0)
+        waitpid(child, &status, 0);
+    else
+        std::this_thread::sleep_for(std::chrono::seconds(duration));
+    frontend.stop();
+    server.stop();
+    if (frontend.dropped() > 0)
+        std::cout << "Заявок без ответа: " << frontend.dropped() << "\n";
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "server.h"
+
+// Транспорт через разделяемую память для клиентов из других процессов.
+// В POSIX shm лежат одно кольцо заявок (много писателей — клиенты, один
+// читатель — ShmFrontend) и по кольцу ответов на клиента. Спящие стороны
+// ждут на futex (без FUTEX_PRIVATE_FLAG, так как слово общее для процессов).
+//
+// Клиентский слот переиспользуется: каждый захват увеличивает его
+// поколение, заявка несёт поколение, и ответы на заявки прежнего владельца
+// (в том числе упавшего процесса) фронтенд и клиент отбрасывают.
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "атомики в shm должны быть без блокировок");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "атомики в shm должны быть без блокировок");
+
+inline void futex_wait(std::atomic<uint32_t> *word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+    timespec ts{static_cast<time_t>(timeout.count() / 1000), static_cast<long>(timeout.count() % 1000) * 1000000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t> *word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+// Ограниченная очередь Вьюкова: у каждой ячейки свой номер поколения,
+// так что писатели и читатели не блокируют друг друга.
+template<typename Item, size_t N>
+struct ShmRing {
+    static_assert((N & (N - 1)) == 0, "размер кольца — степень двойки");
+
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        Item item;
+    };
+
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) Cell cells[N];
+
+    void init()
+    {
+        for (size_t i = 0; i < N; ++i)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    bool push(const Item &item)
+    {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells[pos & (N - 1)];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool pop(Item &item)
+    {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells[pos & (N - 1)];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    item = cell.item;
+                    cell.seq.store(pos + N, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Точка ожидания: счётчик событий + флаг «кто-то спит». Производитель
+// увеличивает счётчик и делает FUTEX_WAKE, только если флаг поднят.
+struct ShmDoorbell {
+    alignas(64) std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> sleeping;
+
+    void init()
+    {
+        seq.store(0, std::memory_order_relaxed);
+        sleeping.store(0, std::memory_order_relaxed);
+    }
+
+    void ring()
+    {
+        seq.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst))
+            futex_wake(&seq);
+    }
+
+    // Спит, пока ready() ложно; таймаут нужен только для проверки остановки.
+    template<typename Pred>
+    void wait(Pred ready, std::chrono::milliseconds timeout)
+    {
+        uint32_t observed = seq.load(std::memory_order_seq_cst);
+        sleeping.store(1, std::memory_order_seq_cst);
+        if (!ready())
+            futex_wait(&seq, observed, timeout);
+        sleeping.store(0, std::memory_order_relaxed);
+    }
+};
+
+struct ShmRequest {
+    uint64_t tag;
+    uint32_t client;
+    uint32_t op;
+    double a;
+    double b;
+    uint32_t generation;
+    uint32_t reserved;
+};
+
+struct ShmCompletion {
+    uint64_t tag;
+    double result;
+    uint32_t status;
+    uint32_t generation;
+};
+
+enum ShmStatus : uint32_t { kShmOk = 0, kShmRejected = 1, kShmShed = 2 };
+
+constexpr uint64_t kShmMagic = 0x50545f53484d3031ull;
+constexpr size_t kShmClients = 16;
+constexpr size_t kShmSubmitSlots = 4096;
+constexpr size_t kShmCompleteSlots = 1024;
+
+struct ShmClientBlock {
+    std::atomic<uint32_t> in_use;
+    std::atomic<uint32_t> generation;
+    ShmDoorbell doorbell;
+    ShmRing<ShmCompletion, kShmCompleteSlots> completions;
+};
+
+struct ShmSegment {
+    std::atomic<uint64_t> magic;
+    std::atomic<uint32_t> shutdown;
+    ShmDoorbell doorbell;
+    ShmRing<ShmRequest, kShmSubmitSlots> requests;
+    ShmClientBlock clients[kShmClients];
+};
+
+inline ShmSegment *map_segment(const std::string &name, bool create)
+{
+    if (create)
+        shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0)
+        throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno));
+    if (create && ftruncate(fd, sizeof(ShmSegment)) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("ftruncate " + name + ": " + std::strerror(errno));
+    }
+    void *ptr = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+        throw std::runtime_error("mmap " + name + ": " + std::strerror(errno));
+    return static_cast<ShmSegment *>(ptr);
+}
+
+// Серверная сторона: создаёт сегмент и в своём потоке перекладывает
+// заявки в Server<double>. Ответ кладёт путь завершения сервера.
+class ShmFrontend {
+public:
+    ShmFrontend(Server<double> &server, std::string name) : server_(server), name_(std::move(name))
+    {
+        seg_ = map_segment(name_, true);
+        new (seg_) ShmSegment;
+        seg_->shutdown.store(0, std::memory_order_relaxed);
+        seg_->doorbell.init();
+        seg_->requests.init();
+        for (auto &client : seg_->clients)
+        {
+            client.in_use.store(0, std::memory_order_relaxed);
+            client.generation.store(0, std::memory_order_relaxed);
+            client.doorbell.init();
+            client.completions.init();
+        }
+        seg_->magic.store(kShmMagic, std::memory_order_release);
+    }
+
+    ~ShmFrontend()
+    {
+        stop();
+        munmap(seg_, sizeof(ShmSegment));
+        shm_unlink(name_.c_str());
+    }
+
+    void start()
+    {
+        running_ = true;
+        thread_ = std::thread(&ShmFrontend::loop, this);
+    }
+
+    void stop()
+    {
+        if (!running_.exchange(false))
+            return;
+        seg_->shutdown.store(1, std::memory_order_release);
+        seg_->doorbell.ring();
+        thread_.join();
+    }
+
+    // Заявки без ответа: чужой номер клиента, прежнее поколение слота или
+    // полное кольцо ответов.
+    size_t dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void loop()
+    {
+        SpinPolicy spin;
+        ShmRequest req;
+        while (running_.load(std::memory_order_relaxed))
+        {
+            if (!seg_->requests.pop(req))
+            {
+                if (spin.spin([&]() { return seg_->requests.pop(req); }))
+                    dispatch(req);
+                else
+                    seg_->doorbell.wait([&]() {
+                        return seg_->requests.tail.load() != seg_->requests.head.load() ||
+                               !running_.load(std::memory_order_relaxed);
+                    }, std::chrono::milliseconds(100));
+                continue;
+            }
+            dispatch(req);
+        }
+    }
+
+    // Заявка пришла из чужого процесса: номер клиента и код операции не
+    // проверены. Без занятого слота ответ некуда положить — заявка теряется.
+    void dispatch(const ShmRequest &req)
+    {
+        if (req.client >= kShmClients || !seg_->clients[req.client].in_use.load(std::memory_order_acquire))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ShmClientBlock *client = &seg_->clients[req.client];
+        const ShmCompletion rejected{req.tag, 0.0, kShmRejected, req.generation};
+        if (!is_typed_op(req.op))
+        {
+            complete(client, rejected);
+            return;
+        }
+        bool accepted = server_.add_op_async(static_cast<Op>(req.op), req.a, req.b,
+            [this, client, tag = req.tag, generation = req.generation](double value, bool shed) {
+                complete(client, {tag, value, shed ? kShmShed : kShmOk, generation});
+            });
+        if (!accepted)
+            complete(client, rejected);
+    }
+
+    // Вызывается и из потока завершения Server, поэтому никогда не ждёт.
+    // ShmClient держит в кольце ответов не больше kShmCompleteSlots, так что
+    // место кончается, только если клиент нарушил протокол; такой ответ, как
+    // и ответ прежнему владельцу слота, теряется и попадает в dropped().
+    void complete(ShmClientBlock *client, const ShmCompletion &done)
+    {
+        if (client->generation.load(std::memory_order_acquire) != done.generation ||
+            !client->completions.push(done))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        client->doorbell.ring();
+    }
+
+    Server<double> &server_;
+    std::string name_;
+    ShmSegment *seg_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> dropped_{0};
+    std::thread thread_;
+};
+
+// Клиентская сторона. Один объект — один поток. В кольце ответов не
+// больше kShmCompleteSlots заявок: при полном окне submit и call вынимают
+// ответы в локальную очередь, откуда их потом отдаёт wait().
+class ShmClient {
+public:
+    explicit ShmClient(const std::string &name)
+    {
+        seg_ = map_segment(name, false);
+        while (seg_->magic.load(std::memory_order_acquire) != kShmMagic)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (uint32_t i = 0; i < kShmClients; ++i)
+        {
+            uint32_t expected = 0;
+            if (seg_->clients[i].in_use.compare_exchange_strong(expected, 1))
+            {
+                index_ = i;
+                block_ = &seg_->clients[i];
+                // Новое поколение отсекает ответы прежнему владельцу; то, что
+                // уже лежит в кольце, выбрасывается здесь, остальное — в receive.
+                generation_ = block_->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+                ShmCompletion stale;
+                while (block_->completions.pop(stale))
+                    ;
+                return;
+            }
+        }
+        munmap(seg_, sizeof(ShmSegment));
+        throw std::runtime_error("Нет свободных клиентских слотов в " + name);
+    }
+
+    // Заявки в полёте не ждутся: их ответы отбросит следующий владелец слота.
+    ~ShmClient()
+    {
+        block_->in_use.store(0, std::memory_order_release);
+        munmap(seg_, sizeof(ShmSegment));
+    }
+
+    // Заявки, ответ на которые ещё не отдан через wait() или call().
+    size_t outstanding() const
+    {
+        return outstanding_;
+    }
+
+    // Возвращает тег заявки. При полном окне сначала вынимает ответ из
+    // кольца в локальную очередь — он достанется следующему wait().
+    uint64_t submit(Op op, double a, double b)
+    {
+        if (outstanding_ - ready_.size() == kShmCompleteSlots)
+            ready_.push_back(receive());
+        ShmRequest req{next_tag_++, index_, static_cast<uint32_t>(op), a, b, generation_, 0};
+        while (!seg_->requests.push(req))
+            std::this_thread::yield();
+        outstanding_++;
+        seg_->doorbell.ring();
+        return req.tag;
+    }
+
+    // Ждёт любой следующий ответ.
+    ShmCompletion wait()
+    {
+        ShmCompletion done;
+        if (!ready_.empty())
+        {
+            done = ready_.front();
+            ready_.pop_front();
+        }
+        else
+            done = receive();
+        outstanding_--;
+        return done;
+    }
+
+    // Синхронный вызов: одна заявка и её ответ. Ответы на асинхронные
+    // заявки, пришедшие раньше, остаются для wait().
+    double call(Op op, double a, double b = 0.0)
+    {
+        const uint64_t tag = submit(op, a, b);
+        ShmCompletion done = receive();
+        while (done.tag != tag)
+        {
+            ready_.push_back(done);
+            done = receive();
+        }
+        outstanding_--;
+        if (done.status == kShmRejected)
+            throw QueueFullError("Очередь сервера заполнена");
+        if (done.status == kShmShed)
+            throw TaskShedError("Задача вытеснена из очереди");
+        return done.result;
+    }
+
+private:
+    // Следующий ответ своего поколения из кольца.
+    ShmCompletion receive()
+    {
+        ShmCompletion done;
+        auto pop = [&]() {
+            while (block_->completions.pop(done))
+                if (done.generation == generation_)
+                    return true;
+            return false;
+        };
+        if (!pop() && !spin_.spin(pop))
+        {
+            while (!pop())
+            {
+                if (seg_->shutdown.load(std::memory_order_acquire))
+                    throw std::runtime_error("Сервер остановлен");
+                block_->doorbell.wait([&]() {
+                    return block_->completions.tail.load() != block_->completions.head.load();
+                }, std::chrono::milliseconds(100));
+            }
+        }
+        return done;
+    }
+
+    ShmSegment *seg_;
+    ShmClientBlock *block_ = nullptr;
+    uint32_t index_ = 0;
+    uint32_t generation_ = 0;
+    uint64_t next_tag_ = 1;
+    size_t outstanding_ = 0;
+    // Ответы, вынутые из кольца submit или call, но ещё не отданные wait().
+    std::deque<ShmCompletion> ready_;
+    SpinPolicy spin_;
+};
@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <thread>
 #include <vector>
+#include "../common/huge_pages.h"
 
 void matrix_vector_product(double *a, double *b, double *c, int m, int n)
 {
@@ -17,10 +18,7 @@ void matrix_vector_product(double *a, double *b, double *c, int m, int n)
 
 const auto run_serial(int m = 20000, int n = 20000)
 {
-    double *a, *b, *c;
-    a = (double *)malloc(sizeof(*a) * m * n);
-    b = (double *)malloc(sizeof(*b) * n);
-    c = (double *)malloc(sizeof(*c) * m);
+    HugeArray<double> a(static_cast<size_t>(m) * n), b(n), c(m);
 
     for (int i = 0; i < m; i++)
     {
@@ -32,15 +30,11 @@ const auto run_serial(int m = 20000, int n = 20000)
         b[j] = j;
 
     const auto start{std::chrono::steady_clock::now()};
-    matrix_vector_product(a, b, c, m, n);
+    matrix_vector_product(a.data(), b.data(), c.data(), m, n);
     const auto end{std::chrono::steady_clock::now()};
     const auto elapsed_ms{std::chrono::duration<double>(end - start).count()};
     std::cout << "Time taken for serial execution: " << elapsed_ms << "s" << std::endl;
 
-    free(a);
-    free(b);
-    free(c);
-
     return elapsed_ms;
 }
 
@@ -74,11 +68,7 @@ void matrix_vector_product_std(double *a, double *b, double *c, int m, int n, in
 
 const auto run_parallel(int num_threads = 4, int m = 20000, int n = 20000)
 {
-    double *a, *b, *c;
-
-    a = (double*)malloc(sizeof(*a) * m * n);
-    b = (double*)malloc(sizeof(*b) * n);
-    c = (double*)malloc(sizeof(*c) * m);
+    HugeArray<double> a(static_cast<size_t>(m) * n), b(n), c(m);
 
     for (int i = 0; i < m; i++)
     {
@@ -91,15 +81,11 @@ const auto run_parallel(int num_threads = 4, int m = 20000, int n = 20000)
 
     
     const auto start{std::chrono::steady_clock::now()};
-    matrix_vector_product_std(a, b, c, m, n, num_threads);
+    matrix_vector_product_std(a.data(), b.data(), c.data(), m, n, num_threads);
     const auto end{std::chrono::steady_clock::now()};
     const auto elapsed_ms{std::chrono::duration<double>(end - start).count()};
     std::cout << "Time taken for parallel execution with threads: " << num_threads << " " << elapsed_ms << "s" << std::endl;
 
-    free(a);
-    free(b);
-    free(c);
-
     return elapsed_ms;
 }
 
@@ -1,185 +1,75 @@
 #include <iostream>
-#include <queue>
-#include <future>
 #include <thread>
-#include <chrono>
-#include <cmath>
 #include <functional>
-#include <mutex>
-#include <condition_variable>
-#include <unordered_map>
 #include <vector>
-#include <fstream>
 #include <random>
+#include <string>
+#include "server.h"
+#include "result_sink.h"
 
-template<typename T>
-T fun_sin(T arg) 
+void client_thread(Server<double>& server, int client_type, size_t N, ResultSink::Channel &out)
 {
-    return std::sin(arg);
-}
-
-template<typename T>
-T fun_sqrt(T arg) 
-{
-    return std::sqrt(arg);
-}
-
-template<typename T>
-T fun_pow(T base, T exponent) 
-{
-    return std::pow(base, exponent);
-}
-
-template<typename T>
-class Server {
-public:
-    Server() : running_(false), task_counter_(0) {}
-
-    void start() 
-    {
-        running_ = true;
-        server_thread_ = std::thread(&Server::server_loop, this);
-    }
-
-    void stop() 
-    {
-        {
-            std::lock_guard<std::mutex> lock(mtx_);
-            running_ = false;
-        }
-        cv_.notify_all();
-        if (server_thread_.joinable())
-            server_thread_.join();
-    }
-
-    size_t add_task(std::function<T()> task) 
-    {
-        std::packaged_task<T()> packaged_task(task);
-        std::future<T> fut = packaged_task.get_future();
-        size_t id;
-        {
-            std::lock_guard<std::mutex> lock(mtx_);
-            id = ++task_counter_;
-            tasks_.push({id, std::move(packaged_task)});
-            temp_futures_[id] = std::move(fut);
-        }
-        cv_.notify_all();
-        return id;
-    }
-
-    T request_result(size_t id) 
-    {
-        std::unique_lock<std::mutex> lock(mtx_);
-        cv_result_.wait(lock, [&]() { return results_.find(id) != results_.end(); });
-        T res = results_[id];
-        results_.erase(id);
-        return res;
-    }
-
-private:
-    std::queue<std::pair<size_t, std::packaged_task<T()>>> tasks_;
-    std::unordered_map<size_t, std::future<T>> temp_futures_;
-    std::unordered_map<size_t, T> results_;
-
-    std::mutex mtx_;
-    std::condition_variable cv_;
-    std::condition_variable cv_result_;
-    std::atomic<bool> running_;
-    size_t task_counter_;
-    std::thread server_thread_;
-
-    void server_loop() {
-
-        while (running_ || !tasks_.empty()) 
-        {
-            std::pair<size_t, std::packaged_task<T()>> task_pair;
-            {
-                std::unique_lock<std::mutex> lock(mtx_);
-                if (tasks_.empty()) 
-                {
-                    cv_.wait_for(lock, std::chrono::milliseconds(50));
-                    continue;
-                }
-                task_pair = std::move(tasks_.front());
-                tasks_.pop();
-            }
-        
-            task_pair.second();
-            T res = temp_futures_[task_pair.first].get();
-            {
-                std::lock_guard<std::mutex> lock(mtx_);
-                results_[task_pair.first] = res;
-                temp_futures_.erase(task_pair.first);
-            }
-            cv_result_.notify_all();
-        }
-        std::cout << "Сервер остановлен." << std::endl;
-    }
-};
-
-void client_thread(Server<double>& server, int client_type, size_t N, const std::string &out_filename) 
-{
-    std::ofstream out(out_filename);
-    if (!out.is_open()) 
-    {
-        std::cerr << "Не получилось открыть файл" << out_filename << std::endl;
-        return;
-    }
-    std::vector<std::pair<size_t, std::string>> tasks_info;
+    std::vector<ResultRecord> tasks_info;
+    tasks_info.reserve(N);
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_real_distribution<> dist(0.1, 5.0);
-    for (size_t i = 0; i < N; ++i) 
+    for (size_t i = 0; i < N; ++i)
     {
-        std::function<double()> task;
-        std::string details;
-        if (client_type == 0) 
+        ResultRecord record{};
+        if (client_type == 0)
         {
-            double arg = std::round(dist(gen) * 10) / 10.0;
-            task = [arg]() { return fun_sin(arg); };
-            details = "операция: sin, число: " + std::to_string(arg);
+            record.op = static_cast<uint32_t>(Op::Sin);
+            record.a = std::round(dist(gen) * 10) / 10.0;
         }
-        else if (client_type == 1) 
+        else if (client_type == 1)
         {
-            double arg = std::round(dist(gen) * 10) / 10.0;
-            task = [arg]() { return fun_sqrt(arg); };
-            details = "операция: sqrt, число: " + std::to_string(arg);
+            record.op = static_cast<uint32_t>(Op::Sqrt);
+            record.a = std::round(dist(gen) * 10) / 10.0;
         }
-        else if (client_type == 2) 
+        else if (client_type == 2)
         {
-            double base = std::round(dist(gen) * 10) / 10.0;
-            double exp  = std::round(dist(gen) * 10) / 10.0;
-            task = [base, exp]() { return fun_pow(base, exp); };
-            details = "операция: pow, числа: " + std::to_string(base) + " и " + std::to_string(exp);
+            record.op = static_cast<uint32_t>(Op::Pow);
+            record.a = std::round(dist(gen) * 10) / 10.0;
+            record.b = std::round(dist(gen) * 10) / 10.0;
         }
-        size_t id = server.add_task(task);
-        tasks_info.push_back({id, details});
+        record.id = server.add_op(static_cast<Op>(record.op), record.a, record.b);
+        tasks_info.push_back(record);
     }
-    for (auto &task : tasks_info) 
+    for (auto &task : tasks_info)
     {
-        double res = server.request_result(task.first);
-        out << "Task ID " << task.first << " " << task.second << " результат: " << res << "\n";
+        task.result = server.request_result(task.id);
+        out.push(task);
     }
-    out.close();
 }
 
-int main() 
+// Результаты пишутся в бинарные *.bin; текстовый вид прежнего формата
+// получается через convert_results (см. Makefile).
+int main(int argc, char* argv[])
 {
     std::cout << "Старт\n";
 
     Server<double> server;
+    server.enable_cache(4096);
     server.start();
 
-    size_t N = 50;
+    size_t N = argc > 1 ? std::stoull(argv[1]) : 50;
+
+    ResultSink sink(SinkFormat::Binary);
+    auto &sin_out = sink.open("sin_results.bin");
+    auto &sqrt_out = sink.open("sqrt_results.bin");
+    auto &pow_out = sink.open("pow_results.bin");
+    sink.start();
 
-    std::thread client1(client_thread, std::ref(server), 0, N, "sin_results.txt");
-    std::thread client2(client_thread, std::ref(server), 1, N, "sqrt_results.txt");
-    std::thread client3(client_thread, std::ref(server), 2, N, "pow_results.txt");
+    std::thread client1(client_thread, std::ref(server), 0, N, std::ref(sin_out));
+    std::thread client2(client_thread, std::ref(server), 1, N, std::ref(sqrt_out));
+    std::thread client3(client_thread, std::ref(server), 2, N, std::ref(pow_out));
 
     client1.join();
     client2.join();
     client3.join();
 
+    sink.close();
     server.stop();
 
     std::cout << "Конец\n";
@@ -1,103 +1,261 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <cmath>
-#include <cstdlib>
+#include <cstring>
 #include <iomanip>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Проверка файлов результатов task2. Файлы отображаются в память, режутся
+// на куски по границам строк, куски проверяются параллельно. Строка:
+// "Task ID <id> операция: <op>, число: <x> результат: <r>" или для pow
+// "... числа: <x> и <y> результат: <r>".
+
+const double tolerance = 0.001;
+
+struct Summary {
+    size_t lines = 0;
+    size_t ok = 0;
+    size_t mismatches = 0;
+    size_t malformed = 0;
+    size_t unsupported = 0;
+    double max_error = 0.0;
+
+    void merge(const Summary &other)
+    {
+        lines += other.lines;
+        ok += other.ok;
+        mismatches += other.mismatches;
+        malformed += other.malformed;
+        unsupported += other.unsupported;
+        max_error = std::max(max_error, other.max_error);
+    }
+};
 
-std::string trimTrailingPunct(const std::string &s, char punct = ',') {
-    if (!s.empty() && s.back() == punct)
-        return s.substr(0, s.size()-1);
-    return s;
+struct Chunk {
+    const char *begin;
+    const char *end;
+};
+
+bool parse_double(std::string_view token, double &value)
+{
+    auto res = std::from_chars(token.data(), token.data() + token.size(), value);
+    return res.ec == std::errc() && res.ptr == token.data() + token.size();
 }
 
-int main() 
+// Разбивает строку на токены по пробелам без выделения памяти.
+size_t split(std::string_view line, std::string_view *tokens, size_t max_tokens)
 {
-    std::ifstream infile("sqrt_results.txt");
-    if (!infile.is_open()) 
+    size_t count = 0;
+    size_t i = 0;
+    while (i < line.size() && count < max_tokens)
     {
-        std::cout << "Не удалось открыть файл" << std::endl;
+        while (i < line.size() && line[i] == ' ')
+            i++;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ')
+            i++;
+        if (i > start)
+            tokens[count++] = line.substr(start, i - start);
     }
+    return count;
+}
 
-    std::string line;
-    int line_no = 0;
-  
-    const double tolerance = 0.001;
-    
-    while (std::getline(infile, line)) 
+// Результат печатается с 6 значащими цифрами, поэтому для |r| > 1 допуск
+// масштабируется по величине ожидаемого значения.
+void check(double computed, double expected, Summary &summary)
+{
+    double diff = std::fabs(computed - expected);
+    summary.max_error = std::max(summary.max_error, diff);
+    if (diff < tolerance * std::max(1.0, std::fabs(expected)))
+        summary.ok++;
+    else
+        summary.mismatches++;
+}
+
+void check_line(std::string_view line, Summary &summary)
+{
+    std::string_view tokens[12];
+    size_t n = split(line, tokens, 12);
+    if (n == 0)
+        return;
+    summary.lines++;
+    if (n < 9)
     {
-        line_no++;
-        if (line.empty())
-            continue;
+        summary.malformed++;
+        return;
+    }
 
-        std::istringstream iss(line);
-        std::vector<std::string> tokens;
-        std::string token;
-        while (iss >> token) 
-        {
-            tokens.push_back(token);
-        }
+    std::string_view op = tokens[4];
+    if (!op.empty() && op.back() == ',')
+        op.remove_suffix(1);
 
-        if (tokens.size() < 9) 
+    if (op == "pow")
+    {
+        double base, exponent, expected;
+        if (n < 11 || !parse_double(tokens[6], base) || !parse_double(tokens[8], exponent) ||
+            !parse_double(tokens[10], expected))
         {
-            std::cout << "Строка " << line_no << ": недостаточно токенов." << std::endl;
+            summary.malformed++;
+            return;
         }
-
-        std::string op = trimTrailingPunct(tokens[4]);
-        
-        if (op == "pow") 
+        check(std::pow(base, exponent), expected, summary);
+    }
+    else if (op == "sin" || op == "sqrt")
+    {
+        double arg, expected;
+        if (!parse_double(tokens[6], arg) || !parse_double(tokens[8], expected))
         {
-            if (tokens.size() < 11) 
-            {
-                std::cerr << "Строка " << line_no << ": недостаточно токенов для операции pow." << std::endl;
-                continue;
-            }
-            double base = std::stod(tokens[6]);
-            double exponent = std::stod(tokens[8]);
-            double expected = std::stod(tokens[10]);
-            double computed = std::pow(base, exponent);
-            if (std::fabs(computed - expected) < tolerance) 
-            {
-                std::cout << "Строка " << line_no << " (pow): верно, вычислено " << computed << ", ожидалось " << expected << std::endl;
-            }
-            else 
-            {
-                std::cout << "Строка " << line_no << " (pow): ошибка, вычислено " << computed << ", ожидалось " << expected << std::endl;
-                std::cout << "diff = " << std::fabs(computed - expected) << std::endl;
-            }
+            summary.malformed++;
+            return;
         }
-        else if (op == "sin" || op == "sqrt") 
+        check(op == "sin" ? std::sin(arg) : std::sqrt(arg), expected, summary);
+    }
+    else
+        summary.unsupported++;
+}
+
+Summary check_chunk(Chunk chunk)
+{
+    Summary summary;
+    const char *p = chunk.begin;
+    while (p < chunk.end)
+    {
+        const char *nl = static_cast<const char *>(memchr(p, '\n', chunk.end - p));
+        const char *line_end = nl ? nl : chunk.end;
+        check_line(std::string_view(p, line_end - p), summary);
+        p = line_end + 1;
+    }
+    return summary;
+}
+
+// Куски не меньше min_bytes, граница сдвигается до конца строки.
+void split_chunks(const char *data, size_t size, size_t pieces, std::vector<Chunk> &chunks)
+{
+    const size_t min_bytes = 1 << 20;
+    size_t step = std::max(min_bytes, size / std::max<size_t>(1, pieces));
+    const char *end = data + size;
+    const char *p = data;
+    while (p < end)
+    {
+        const char *q = p + std::min(step, static_cast<size_t>(end - p));
+        if (q < end)
         {
-            if (tokens.size() < 9) 
-            {
-                std::cerr << "Строка " << line_no << ": недостаточно токенов для операции " << op << std::endl;
-                continue;
-            }
-            double arg = std::stod(tokens[6]);
-            double expected = std::stod(tokens[8]);
-            double computed = 0.0;
-            if (op == "sin")
-                computed = std::sin(arg);
-            else
-                computed = std::sqrt(arg);
-
-            if (std::fabs(computed - expected) < tolerance) 
-            {
-                std::cout << "Строка " << line_no << " (" << op << "): верно, вычислено " << computed << ", ожидалось " << expected << std::endl;
-            }
-            else 
-            {
-                std::cout << "Строка " << line_no << " (" << op << "): ошибка, вычислено " << computed << ", ожидалось " << expected << std::endl;
-                std::cout << "diff = " << std::fabs(computed - expected) << std::endl;
-            }
+            const char *nl = static_cast<const char *>(memchr(q, '\n', end - q));
+            q = nl ? nl + 1 : end;
         }
-        else 
+        chunks.push_back({p, q});
+        p = q;
+    }
+}
+
+struct MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+    int fd = -1;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const char *path)
+    {
+        fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            return false;
+        size = st.st_size;
+        if (size == 0)
+            return true;
+        void *ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+            return false;
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(ptr);
+        return true;
+    }
+
+    ~MappedFile()
+    {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = {"sin_results.txt", "sqrt_results.txt", "pow_results.txt"};
+
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    const auto start{std::chrono::steady_clock::now()};
+
+    std::vector<MappedFile> files(paths.size());
+    std::vector<Chunk> chunks;
+    std::vector<size_t> chunk_file;
+    bool failed = false;
+    for (size_t f = 0; f < paths.size(); ++f)
+    {
+        if (!files[f].open(paths[f].c_str()))
         {
-            std::cout << "Строка " << line_no << ": неподдерживаемая операция '" << op << "'" << std::endl;
+            std::cout << "Не удалось открыть файл " << paths[f] << std::endl;
+            failed = true;
+            continue;
         }
+        split_chunks(files[f].data, files[f].size, threads * 4, chunks);
+        chunk_file.resize(chunks.size(), f);
+    }
+
+    std::vector<Summary> results(chunks.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < std::min(threads, chunks.size()); ++t)
+    {
+        workers.emplace_back([&]() {
+            for (size_t c = next++; c < chunks.size(); c = next++)
+                results[c] = check_chunk(chunks[c]);
+        });
     }
-    infile.close();
+    for (auto &worker : workers)
+        worker.join();
+
+    std::vector<Summary> per_file(paths.size());
+    for (size_t c = 0; c < chunks.size(); ++c)
+        per_file[chunk_file[c]].merge(results[c]);
+
+    const auto end{std::chrono::steady_clock::now()};
+    Summary total;
+    for (size_t f = 0; f < paths.size(); ++f)
+    {
+        const Summary &s = per_file[f];
+        std::cout << paths[f] << ": строк " << s.lines << ", верно " << s.ok
+                  << ", ошибок " << s.mismatches << ", некорректных " << s.malformed
+                  << ", неподдерживаемых " << s.unsupported
+                  << ", макс. отклонение " << std::scientific << std::setprecision(3) << s.max_error
+                  << std::defaultfloat << "\n";
+        total.merge(s);
+    }
+    const double elapsed = std::chrono::duration<double>(end - start).count();
+    std::cout << "Итого: " << total.lines << " строк за " << elapsed << " с ("
+              << total.lines / elapsed << " строк/с, потоков: " << threads << ")\n";
+
+    if (failed || total.mismatches || total.malformed || total.unsupported)
+        return 1;
     return 0;
 }
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "grid.h"
+
+// Якоби с замороженными плитками. Внутренность сетки делится на плитки
+// tile x tile; у каждой запоминается наибольшее изменение за проход.
+//
+// Пропуск плитки — это возмущение итерации Якоби на величину её
+// непосчитанного изменения, а шаг Якоби в max-норме не растягивает
+// возмущения. Поэтому сетка отличается от полного Якоби на той же
+// итерации не больше, чем на сумму по проходам наибольшего пропущенного
+// изменения. Его оценка сверху для замороженной плитки:
+//   - при заморозке — наибольшее изменение за проход у неё и у соседей
+//     (следующее изменение — среднее от последних);
+//   - за каждый проход она растёт на наибольшее изменение соседей: через
+//     рамку плитка видит сдвиг их значений с весом не больше единицы.
+//
+// Плитка замораживается, когда эта оценка ниже freeze_ratio * accuracy,
+// и просыпается, как только оценка дорастает до порога. Сумма оценок
+// расходуется из бюджета lag_ratio * accuracy; когда его не хватает на
+// следующий проход, все плитки просыпаются и заморозка больше не
+// применяется. Значит, итоговое отставание от полного Якоби не больше
+// lag_ratio * accuracy.
+//
+// Раз в revalidate итераций и перед остановкой делается полный проход по
+// всем плиткам: он заменяет оценки измеренными изменениями, а решение
+// заканчивается, только когда ошибка полного прохода не больше accuracy,
+// как у solve_jacobi.
+
+struct ActiveTileOptions {
+    size_t tile = 32;
+    double freeze_ratio = 0.001;
+    double lag_ratio = 1.0;
+    int revalidate = 1000;
+};
+
+// Плитка [i0, i1) x [j0, j1) из src в dst; наибольшее изменение.
+inline double update_tile(const double* src, double* dst, size_t size, size_t i0, size_t i1, size_t j0, size_t j1)
+{
+    double error = 0.0;
+    for (size_t i = i0; i < i1; ++i)
+    {
+        const double* up = src + (i-1)*size;
+        const double* mid = src + i*size;
+        const double* down = src + (i+1)*size;
+        double* out = dst + i*size;
+        #pragma omp simd reduction(max:error)
+        for (size_t j = j0; j < j1; ++j)
+        {
+            const double value = 0.25 * (down[j] + up[j] + mid[j-1] + mid[j+1]);
+            out[j] = value;
+            const double change = std::fabs(value - mid[j]);
+            error = change > error ? change : error;
+        }
+    }
+    return error;
+}
+
+// cells_updated, если задан, получает число пересчитанных клеток за всё решение.
+SolveResult solve_jacobi_active(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                                bool verbose, ActiveTileOptions options, long long* cells_updated = nullptr)
+{
+    const size_t interior = size - 2;
+    const size_t tile = std::max<size_t>(1, options.tile);
+    const size_t nt = (interior + tile - 1) / tile;
+    const size_t tiles = nt * nt;
+    const double threshold = options.freeze_ratio * accuracy;
+    const double budget = options.lag_ratio * accuracy;
+    const int revalidate = std::max(1, options.revalidate);
+
+    auto bounds = [&](size_t t, size_t& i0, size_t& i1, size_t& j0, size_t& j1) {
+        i0 = 1 + (t / nt) * tile;
+        i1 = std::min(i0 + tile, size - 1);
+        j0 = 1 + (t % nt) * tile;
+        j1 = std::min(j0 + tile, size - 1);
+    };
+    // Наибольшее изменение за проход у соседей по стороне.
+    auto neighbours = [&](const std::vector<double>& values, size_t t) {
+        const size_t r = t / nt, c = t % nt;
+        double value = 0.0;
+        if (r > 0)
+            value = std::max(value, values[t - nt]);
+        if (r + 1 < nt)
+            value = std::max(value, values[t + nt]);
+        if (c > 0)
+            value = std::max(value, values[t - 1]);
+        if (c + 1 < nt)
+            value = std::max(value, values[t + 1]);
+        return value;
+    };
+
+    std::vector<char> frozen(tiles, 0);
+    // Изменение плитки за последний проход (0 у замороженной) и оценка
+    // сверху изменения, которое замороженная плитка пропустит в следующем.
+    std::vector<double> change(tiles, 0.0);
+    std::vector<double> missed(tiles, 0.0);
+    std::vector<long> list;
+    list.reserve(tiles);
+
+    memcpy(Anew, A, size * size * sizeof(double));
+    double* src = A;
+    double* dst = Anew;
+
+    double error = accuracy + 1.0;
+    int iteration = 0;
+    long long cells = 0;
+    double spent = 0.0;
+    bool exhausted = budget <= 0.0;
+    bool final_check = false;
+    while (iteration < max_iterations)
+    {
+        const bool full = final_check || (iteration + 1) % revalidate == 0;
+        list.clear();
+        for (size_t t = 0; t < tiles; ++t)
+        {
+            if (full || !frozen[t])
+                list.push_back(t);
+            else
+                change[t] = 0.0;
+        }
+
+        double sweep_error = 0.0;
+        long long sweep_cells = 0;
+        #pragma omp parallel for schedule(dynamic) reduction(max:sweep_error) reduction(+:sweep_cells)
+        for (long k = 0; k < static_cast<long>(list.size()); ++k)
+        {
+            size_t i0, i1, j0, j1;
+            bounds(list[k], i0, i1, j0, j1);
+            change[list[k]] = update_tile(src, dst, size, i0, i1, j0, j1);
+            sweep_error = std::max(sweep_error, change[list[k]]);
+            sweep_cells += static_cast<long long>(i1 - i0) * (j1 - j0);
+        }
+        std::swap(src, dst);
+        iteration++;
+        cells += sweep_cells;
+        error = sweep_error;
+
+        if (verbose && iteration % 10000 == 0)
+        {
+            std::cout << "Итерация: " << iteration << ", ошибка: " << error << ", активных плиток: "
+                      << std::count(frozen.begin(), frozen.end(), 0) << " из " << tiles << "\n";
+        }
+
+        if (full)
+        {
+            std::fill(frozen.begin(), frozen.end(), 0);
+            if (!(error > accuracy))
+                break;
+        }
+        // Проход без замороженных плиток дошёл до точности — проверить полным.
+        final_check = !full && !(error > accuracy);
+        if (exhausted || final_check)
+        {
+            std::fill(frozen.begin(), frozen.end(), 0);
+            continue;
+        }
+
+        // Оценки по состоянию после прохода: замороженные копят изменения
+        // соседей, остальные берут наибольшее изменение у себя и у соседей.
+        double lag = 0.0;
+        for (size_t t = 0; t < tiles; ++t)
+        {
+            const double around = neighbours(change, t);
+            if (frozen[t])
+                missed[t] += around;
+            else
+                missed[t] = std::max(change[t], around);
+            const bool freeze = missed[t] < threshold;
+            if (freeze && !frozen[t])
+            {
+                // Замораживаемая плитка должна совпадать в обоих буферах.
+                size_t i0, i1, j0, j1;
+                bounds(t, i0, i1, j0, j1);
+                for (size_t i = i0; i < i1; ++i)
+                    memcpy(dst + i*size + j0, src + i*size + j0, (j1 - j0) * sizeof(double));
+            }
+            frozen[t] = freeze;
+            if (freeze)
+                lag = std::max(lag, missed[t]);
+        }
+        if (spent + lag > budget)
+        {
+            std::fill(frozen.begin(), frozen.end(), 0);
+            exhausted = true;
+        }
+        else
+            spent += lag;
+    }
+
+    if (src != A)
+        copy_matrix(A, src, size);
+    if (cells_updated)
+        *cells_updated = cells;
+    return {iteration, error};
+}
@@ -0,0 +1,649 @@
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <omp.h>
+#include "grid.h"
+#include "stencil_kernels.h"
+#include "temporal_blocking.h"
+#include "red_black.h"
+#include "multigrid.h"
+#include "persistent.h"
+#include "precision.h"
+#include "checkpoint.h"
+#include "ensemble.h"
+#include "active_tiles.h"
+#include "../common/huge_pages.h"
+
+namespace po = boost::program_options;
+
+using bench_clock = std::chrono::steady_clock;
+
+// Фиксированное число итераций, поэтому скорость не зависит от
+// сходимости. MLUP/s — миллионы обновлённых внутренних ячеек в секунду.
+
+// Точность для прогонов на фиксированное число итераций. Нуля мало: на
+// маленькой сетке изменение за проход становится ровно 0 (34x34 — после
+// 7293 итераций Якоби, float — после 2798), и решатель останавливается
+// раньше, чем рассчитывает замер. error > -1 верно всегда.
+constexpr double kFixedIterations = -1.0;
+
+std::vector<size_t> parse_sizes(const std::string &list)
+{
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        sizes.push_back(std::stoul(item));
+    return sizes;
+}
+
+template<typename Solver>
+double run(Solver solve, size_t size, int iterations, std::vector<double> &grid)
+{
+    grid.assign(size * size, 0.0);
+    std::vector<double> other(size * size);
+    initialize(grid.data(), other.data(), size);
+    const auto start{bench_clock::now()};
+    solve(grid.data(), other.data(), size, kFixedIterations, iterations);
+    const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+    return static_cast<double>(size - 2) * (size - 2) * iterations / elapsed / 1e6;
+}
+
+void bench_tiled(const std::vector<size_t> &sizes, int iterations, int time_steps)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", итераций: " << iterations << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> naive_grid, tiled_grid;
+        double naive = run([](double* A, double* Anew, size_t n, double acc, int it) {
+            solve_jacobi(A, Anew, n, acc, it, false);
+        }, size, iterations, naive_grid);
+        double tiled = run([time_steps](double* A, double* Anew, size_t n, double acc, int it) {
+            solve_jacobi_tiled(A, Anew, n, acc, it, false, time_steps);
+        }, size, iterations, tiled_grid);
+        const TemporalBlocking blocking = choose_blocking(size, time_steps);
+        const bool same = memcmp(naive_grid.data(), tiled_grid.data(), size * size * sizeof(double)) == 0;
+        std::cout << "  " << size << "x" << size << ": исходный " << naive << " MLUP/s, блоки ("
+                  << blocking.time_steps << " шагов x " << blocking.band_rows << " строк) " << tiled
+                  << " MLUP/s (x" << tiled / naive << "), " << (same ? "совпадает побитно" : "РАСХОДИТСЯ") << "\n";
+    }
+}
+
+// Исходный calculate_next_grid против ядер строк для каждого доступного
+// набора инструкций; скорость на поток показывает выигрыш на одно ядро.
+void bench_isa(const std::vector<size_t> &sizes, int iterations)
+{
+    const int threads = omp_get_max_threads();
+    std::cout << "Потоков: " << threads << ", итераций: " << iterations << ", лучший набор: "
+              << isa_name(best_isa()) << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> reference;
+        double base = run([](double* A, double* Anew, size_t n, double acc, int it) {
+            solve_jacobi(A, Anew, n, acc, it, false);
+        }, size, iterations, reference);
+        std::cout << "  " << size << "x" << size << ": исходный " << base / threads << " MLUP/s на поток\n";
+        for (Isa isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512})
+        {
+            if (!isa_supported(isa))
+                continue;
+            std::vector<double> grid;
+            RowKernel kernel = row_kernel(isa);
+            double mlups = run([kernel](double* A, double* Anew, size_t n, double acc, int it) {
+                solve_jacobi(A, Anew, n, acc, it, false, kernel);
+            }, size, iterations, grid);
+            const bool same = memcmp(reference.data(), grid.data(), size * size * sizeof(double)) == 0;
+            std::cout << "    " << isa_name(isa) << ": " << mlups / threads << " MLUP/s на поток (x" << mlups / base
+                      << "), " << (same ? "совпадает побитно" : "РАСХОДИТСЯ") << "\n";
+        }
+    }
+}
+
+// Время до точности: Якоби с лучшим ядром строки, Гаусс-Зейдель и SOR
+// с оптимальным omega на одной и той же задаче.
+void bench_methods(const std::vector<size_t> &sizes, double accuracy, int max_iterations)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", точность: " << accuracy << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> A(size * size), Anew(size * size);
+        std::cout << "  " << size << "x" << size << ":\n";
+        for (const char* method : {"jacobi", "gauss_seidel", "sor"})
+        {
+            initialize(A.data(), Anew.data(), size);
+            const std::string name = method;
+            const double omega = name == "sor" ? optimal_omega(size) : 1.0;
+            const auto start{bench_clock::now()};
+            SolveResult result = name == "jacobi"
+                ? solve_jacobi(A.data(), Anew.data(), size, accuracy, max_iterations, false, row_kernel(best_isa()))
+                : solve_red_black(A.data(), size, accuracy, max_iterations, false, omega);
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            std::cout << "    " << method << ": " << result.iterations << " итераций, " << elapsed << " с";
+            if (name == "sor")
+                std::cout << " (omega " << omega << ")";
+            std::cout << "\n";
+        }
+    }
+}
+
+// Время до точности для вариантов multigrid; SOR для сравнения только
+// до sor_max, дальше он слишком долгий. Время включает построение уровней.
+void bench_multigrid(const std::vector<size_t> &sizes, double accuracy, size_t sor_max)
+{
+    struct Variant {
+        const char* name;
+        Cycle cycle;
+        Smoother smoother;
+    };
+    const Variant variants[] = {
+        {"V, red-black", Cycle::V, Smoother::RedBlack},
+        {"F, red-black", Cycle::F, Smoother::RedBlack},
+        {"V, jacobi", Cycle::V, Smoother::Jacobi},
+    };
+
+    std::cout << "Потоков: " << omp_get_max_threads() << ", точность: " << accuracy << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> A(size * size);
+        std::cout << "  " << size << "x" << size << ":\n";
+        for (const Variant& variant : variants)
+        {
+            initialize(A.data(), A.data(), size);
+            const auto start{bench_clock::now()};
+            MultigridOptions options;
+            options.cycle = variant.cycle;
+            options.smoother = variant.smoother;
+            Multigrid mg(size, options);
+            SolveResult result = mg.solve(A.data(), accuracy, 1000, false);
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            std::cout << "    multigrid " << variant.name << ": " << result.iterations << " циклов, " << elapsed
+                      << " с (уровней " << mg.levels() << ")\n";
+        }
+        if (size <= sor_max)
+        {
+            initialize(A.data(), A.data(), size);
+            const auto start{bench_clock::now()};
+            SolveResult result = solve_red_black(A.data(), size, accuracy, 10000000, false, optimal_omega(size));
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            std::cout << "    sor: " << result.iterations << " итераций, " << elapsed << " с\n";
+        }
+    }
+}
+
+// Накладные расходы на итерацию: исходный цикл (две параллельные области
+// и копирование), постоянная область с проверкой на каждой итерации и
+// с проверками по расписанию. Разница времени на итерацию — сэкономленные
+// вход/выход из областей и общая редукция ошибки.
+void bench_persistent(const std::vector<size_t> &sizes, double accuracy, int interval)
+{
+    const RowKernel kernel = row_kernel(best_isa());
+    std::cout << "Потоков: " << omp_get_max_threads() << ", точность: " << accuracy << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> reference(size * size), A(size * size), Anew(size * size);
+        std::cout << "  " << size << "x" << size << ":\n";
+
+        auto timed = [&](const char* name, auto solve) {
+            initialize(A.data(), Anew.data(), size);
+            const auto start{bench_clock::now()};
+            SolveResult result = solve();
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            const double per_iteration = elapsed / result.iterations * 1e6;
+            std::cout << "    " << name << ": " << result.iterations << " итераций, " << elapsed << " с, "
+                      << per_iteration << " мкс/итер.";
+            return per_iteration;
+        };
+
+        const double base = timed("исходный", [&]() {
+            return solve_jacobi(A.data(), Anew.data(), size, accuracy, 1000000, false, kernel);
+        });
+        std::cout << "\n";
+        reference = A;
+
+        const double every = timed("постоянная область, проверка каждую итерацию", [&]() {
+            return solve_jacobi_persistent(A.data(), Anew.data(), size, accuracy, 1000000, false,
+                                           {CheckPolicy::Every, 1}, kernel);
+        });
+        const bool same = memcmp(reference.data(), A.data(), size * size * sizeof(double)) == 0;
+        std::cout << ", " << (same ? "совпадает побитно" : "РАСХОДИТСЯ") << "\n";
+
+        const double fixed = timed("проверка раз в interval", [&]() {
+            return solve_jacobi_persistent(A.data(), Anew.data(), size, accuracy, 1000000, false,
+                                           {CheckPolicy::Fixed, interval}, kernel);
+        });
+        std::cout << "\n";
+        timed("адаптивная проверка", [&]() {
+            return solve_jacobi_persistent(A.data(), Anew.data(), size, accuracy, 1000000, false,
+                                           {CheckPolicy::Adaptive, interval * 10}, kernel);
+        });
+        std::cout << "\n";
+        std::cout << "    сэкономлено на итерацию: области и копирование " << base - every
+                  << " мкс, редукция " << every - fixed << " мкс\n";
+    }
+}
+
+// Время до точности по типам сетки. Отклонение — максимум разности
+// с решением в double (шаблонное ядро, тот же цикл).
+void bench_precision(const std::vector<size_t> &sizes, double accuracy, int max_iterations)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", точность: " << accuracy << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<double> reference(size * size), A(size * size), Anew(size * size);
+        std::cout << "  " << size << "x" << size << ":\n";
+        double base = 0.0;
+        for (Precision precision : {Precision::Double, Precision::Float, Precision::FloatDoubleError, Precision::Mixed})
+        {
+            initialize(A.data(), Anew.data(), size);
+            const auto start{bench_clock::now()};
+            SolveResult result = solve_jacobi_precision(A.data(), Anew.data(), size, accuracy, max_iterations, false,
+                                                        precision);
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            if (precision == Precision::Double)
+            {
+                reference = A;
+                base = elapsed;
+            }
+            double deviation = 0.0;
+            for (size_t k = 0; k < size * size; ++k)
+                deviation = std::max(deviation, std::fabs(A[k] - reference[k]));
+            std::cout << "    " << precision_name(precision) << ": " << result.iterations << " итераций, "
+                      << elapsed << " с (x" << base / elapsed << "), ошибка " << result.error
+                      << ", отклонение " << deviation
+                      << (result.error > accuracy ? ", точность не достигнута" : "") << "\n";
+        }
+    }
+}
+
+// Полный прогон до точности: число итераций и сетка должны совпасть.
+void check_converged(size_t size, double accuracy, int time_steps)
+{
+    std::vector<double> A(size * size), Anew(size * size), B(size * size), Bnew(size * size);
+    initialize(A.data(), Anew.data(), size);
+    initialize(B.data(), Bnew.data(), size);
+    SolveResult naive = solve_jacobi(A.data(), Anew.data(), size, accuracy, 1000000, false);
+    SolveResult tiled = solve_jacobi_tiled(B.data(), Bnew.data(), size, accuracy, 1000000, false, time_steps);
+    const bool same = naive.iterations == tiled.iterations && naive.error == tiled.error &&
+                      memcmp(A.data(), B.data(), size * size * sizeof(double)) == 0;
+    std::cout << "До точности " << accuracy << " на " << size << "x" << size << ": " << naive.iterations
+              << " и " << tiled.iterations << " итераций, " << (same ? "совпадает побитно" : "РАСХОДИТСЯ") << "\n";
+}
+
+// Замедление решателя от фоновых точек каждые interval итераций против
+// того же цикла без точек. Продолжение с середины через файл должно дать
+// ту же сетку, что и прогон без остановки.
+void bench_checkpoint(const std::vector<size_t> &sizes, int iterations, int interval, const std::string &path)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", итераций: " << iterations << ", точка каждые "
+              << interval << "\n";
+    const RowKernel kernel = row_kernel(best_isa());
+    for (size_t size : sizes)
+    {
+        std::vector<double> plain_grid, checkpointed_grid;
+        const double plain = run([kernel](double* A, double* Anew, size_t n, double acc, int it) {
+            solve_jacobi_checkpointed(A, Anew, n, acc, it, false, kernel, nullptr, 0);
+        }, size, iterations, plain_grid);
+
+        CheckpointWriter writer(path, size);
+        const double checkpointed = run([&](double* A, double* Anew, size_t n, double acc, int it) {
+            solve_jacobi_checkpointed(A, Anew, n, acc, it, false, kernel, &writer, interval);
+        }, size, iterations, checkpointed_grid);
+
+        std::vector<double> A(size * size), Anew(size * size);
+        initialize(A.data(), Anew.data(), size);
+        {
+            CheckpointWriter half(path, size);
+            solve_jacobi_checkpointed(A.data(), Anew.data(), size, kFixedIterations, iterations / 2, false, kernel, &half, 0);
+        }
+        initialize(A.data(), Anew.data(), size);
+        {
+            MappedCheckpoint resume(path);
+            memcpy(A.data(), resume.grid(), size * size * sizeof(double));
+            solve_jacobi_checkpointed(A.data(), Anew.data(), size, kFixedIterations, iterations, false, kernel, nullptr, 0,
+                                      static_cast<int>(resume.header().iteration), resume.header().error);
+        }
+        const bool same = memcmp(A.data(), plain_grid.data(), size * size * sizeof(double)) == 0;
+
+        std::cout << "  " << size << "x" << size << ": без точек " << plain << " MLUP/s, с точками "
+                  << checkpointed << " MLUP/s, замедление " << (plain / checkpointed - 1.0) * 100 << "%, записано "
+                  << writer.written() << ", пропущено " << writer.skipped() << ", продолжение "
+                  << (same ? "совпадает" : "ОТЛИЧАЕТСЯ") << "\n";
+    }
+    std::remove(path.c_str());
+}
+
+// Ансамбль из count задач одного размера с разными углами: по очереди
+// через solve_jacobi, по задаче на поток и пачками с SIMD по задачам.
+// Сетки сравниваются с последовательным решением побитно.
+void bench_ensemble(const std::vector<size_t> &sizes, size_t count, double accuracy, int max_iterations)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", задач: " << count << ", точность: " << accuracy << "\n";
+    for (size_t size : sizes)
+    {
+        std::vector<GridProblem> problems;
+        for (size_t k = 0; k < count; ++k)
+            problems.push_back({size, {10.0 + k % 7, 20.0 - k % 5, 30.0 + k % 3, 20.0 + k % 11}});
+
+        std::vector<std::vector<double>> reference(count);
+        const auto start{bench_clock::now()};
+        for (size_t k = 0; k < count; ++k)
+        {
+            reference[k].resize(size * size);
+            std::vector<double> Anew(size * size);
+            initialize(reference[k].data(), Anew.data(), size, problems[k].corners);
+            solve_jacobi(reference[k].data(), Anew.data(), size, accuracy, max_iterations, false);
+        }
+        const double loop = count / std::chrono::duration<double>(bench_clock::now() - start).count();
+        std::cout << "  " << size << "x" << size << ": solve_jacobi по очереди " << loop << " сеток/с\n";
+
+        for (size_t packed_max : {size_t(0), kEnsemblePackedMaxSize})
+        {
+            std::vector<std::vector<double>> grids;
+            const auto begin{bench_clock::now()};
+            solve_ensemble(problems, accuracy, max_iterations, grids, packed_max);
+            const double rate = count / std::chrono::duration<double>(bench_clock::now() - begin).count();
+            bool same = true;
+            for (size_t k = 0; k < count; ++k)
+                same = same && grids[k] == reference[k];
+            std::cout << "    " << (packed_max == 0 ? "задача на поток" : "пачки по задачам") << ": " << rate
+                      << " сеток/с (x" << rate / loop << "), " << (same ? "совпадает побитно" : "РАСХОДИТСЯ") << "\n";
+        }
+    }
+}
+
+// Полный проход и замороженные плитки из одного начального состояния:
+// итерации, время, клеток за итерацию и отклонение сеток друг от друга.
+void compare_active(const char* label, const std::vector<double> &start_grid, size_t size, double accuracy,
+                    ActiveTileOptions options)
+{
+    std::vector<double> reference(start_grid), A(start_grid), Anew(start_grid);
+    auto start{bench_clock::now()};
+    SolveResult full = solve_jacobi(reference.data(), Anew.data(), size, accuracy, 10000000, false,
+                                    row_kernel(best_isa()));
+    const double full_time = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    long long cells = 0;
+    start = bench_clock::now();
+    SolveResult result = solve_jacobi_active(A.data(), Anew.data(), size, accuracy, 10000000, false, options, &cells);
+    const double active_time = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    double deviation = 0.0;
+    for (size_t k = 0; k < size * size; ++k)
+        deviation = std::max(deviation, std::fabs(A[k] - reference[k]));
+    const double per_iteration = static_cast<double>(cells) / std::max(1, result.iterations);
+    std::cout << "    " << label << ": полный проход " << full.iterations << " итераций, " << full_time
+              << " с; плитки " << result.iterations << " итераций, " << active_time << " с (x"
+              << full_time / active_time << "), клеток за итерацию " << per_iteration << " ("
+              << per_iteration / ((size - 2) * (size - 2)) * 100 << "%), ошибка " << result.error << ", отклонение "
+              << deviation << "\n";
+}
+
+// Холодный старт — исходная задача с нулевой внутренностью. Тёплый —
+// решение задачи (multigrid до accuracy * 1e-6, чтобы сетка вдали не
+// дрейфовала) с возмущённым на +1 квадратом size/64 x size/64: изменение
+// сосредоточено у возмущения, остальные плитки могут спать.
+void bench_active(const std::vector<size_t> &sizes, double accuracy, ActiveTileOptions options)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", точность: " << accuracy << ", плитка: " << options.tile
+              << ", порог: " << options.freeze_ratio << " * accuracy, бюджет: " << options.lag_ratio << " * accuracy\n";
+    for (size_t size : sizes)
+    {
+        std::cout << "  " << size << "x" << size << ":\n";
+        std::vector<double> grid(size * size), other(size * size);
+        initialize(grid.data(), other.data(), size);
+        compare_active("холодный старт", grid, size, accuracy, options);
+
+        Multigrid(size, MultigridOptions{}).solve(grid.data(), accuracy * 1e-6, 1000, false);
+        const size_t first = size / 4, side = std::max<size_t>(1, size / 64);
+        for (size_t i = first; i < first + side; ++i)
+            for (size_t j = first; j < first + side; ++j)
+                grid[i*size + j] += 1.0;
+        compare_active("тёплый старт", grid, size, accuracy, options);
+    }
+}
+
+// Пропускная способность памяти по STREAM triad a = b + s * c: лучший
+// из повторов, 24 байта на элемент, как считает сам STREAM.
+double stream_triad(size_t elements, int repeats)
+{
+    std::vector<double> a(elements), b(elements), c(elements);
+    #pragma omp parallel for
+    for (long k = 0; k < static_cast<long>(elements); ++k)
+    {
+        a[k] = 0.0;
+        b[k] = 1.0;
+        c[k] = 2.0;
+    }
+    double best = 0.0;
+    for (int r = 0; r < repeats; ++r)
+    {
+        const auto start{bench_clock::now()};
+        #pragma omp parallel for
+        for (long k = 0; k < static_cast<long>(elements); ++k)
+            a[k] = b[k] + 3.0 * c[k];
+        const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+        best = std::max(best, 24.0 * elements / elapsed / 1e9);
+    }
+    return best + a[elements / 2] * 0.0;
+}
+
+// Вариант решателя для развёртки. bytes — обязательный трафик памяти на
+// обновление клетки без учёта повторного использования в кэше:
+// reference и kernel читают и пишут сетку в пересчёте и в copy_matrix
+// (32 байта), persistent меняет буферы местами (16), tiled делает
+// time_steps шагов за один проход по памяти (16 / T), SOR на месте читает
+// сетку и пишет половину в каждом из двух полупроходов (24), float вдвое
+// меньше persistent (8). flops — 4 операции шаблона на клетку.
+struct SweepVariant {
+    std::string name;
+    double bytes;
+    std::function<void(double*, double*, size_t, int)> solve;
+    // Подготовка вне замера, если нужна (float: свои буферы).
+    std::function<void(const double*, size_t)> prepare;
+};
+
+std::vector<SweepVariant> sweep_variants(const std::string &list, size_t size, int time_steps)
+{
+    const RowKernel kernel = row_kernel(best_isa());
+    const TemporalBlocking blocking = choose_blocking(size, time_steps);
+    std::vector<SweepVariant> variants;
+    std::stringstream ss(list);
+    std::string name;
+    while (std::getline(ss, name, ','))
+    {
+        if (name == "reference")
+            variants.push_back({name, 32.0, [](double* A, double* Anew, size_t n, int it) {
+                solve_jacobi(A, Anew, n, kFixedIterations, it, false);
+            }});
+        else if (name == "kernel")
+            variants.push_back({name, 32.0, [kernel](double* A, double* Anew, size_t n, int it) {
+                solve_jacobi(A, Anew, n, kFixedIterations, it, false, kernel);
+            }});
+        else if (name == "persistent")
+            variants.push_back({name, 16.0, [kernel](double* A, double* Anew, size_t n, int it) {
+                solve_jacobi_persistent(A, Anew, n, kFixedIterations, it, false, parse_check_schedule("fixed", 100), kernel);
+            }});
+        else if (name == "tiled")
+            variants.push_back({name, 16.0 / blocking.time_steps, [kernel, time_steps](double* A, double* Anew,
+                                                                                     size_t n, int it) {
+                solve_jacobi_tiled(A, Anew, n, kFixedIterations, it, false, time_steps, kernel);
+            }});
+        else if (name == "sor")
+            variants.push_back({name, 24.0, [](double* A, double*, size_t n, int it) {
+                solve_red_black(A, n, kFixedIterations, it, false, optimal_omega(n));
+            }});
+        else if (name == "float")
+        {
+            // Буферы float и перевод сетки — в prepare, вне замера.
+            auto grids = std::make_shared<std::pair<std::vector<float>, std::vector<float>>>();
+            variants.push_back({name, 8.0, [grids](double*, double*, size_t n, int it) {
+                solve_jacobi_typed<float, float>(grids->first.data(), grids->second.data(), n, kFixedIterations, it,
+                                                 false);
+            }, [grids](const double* A, size_t n) {
+                grids->first.resize(n * n);
+                grids->second.resize(n * n);
+                convert_grid(A, grids->first.data(), n);
+            }});
+        }
+        else
+            std::cout << "Неизвестный вариант: " << name << "\n";
+    }
+    return variants;
+}
+
+// Развёртка по числу потоков, размерам и вариантам на фиксированном числе
+// итераций, независимо от сходимости. Итерации растут для маленьких сеток,
+// чтобы каждый замер обновлял не меньше 1e8 клеток. Для каждого числа
+// потоков сначала меряется STREAM triad; GB/s — MLUP/s, умноженные на
+// трафик варианта, доля — от STREAM. CSV — точки для графика roofline.
+void bench_sweep(const std::vector<size_t> &sizes, const std::vector<size_t> &threads, const std::string &list,
+                 int iterations, int time_steps, const std::string &csv_path)
+{
+    std::ofstream csv(csv_path);
+    csv << "variant,threads,size,working_set_bytes,iterations,seconds,mlups,bytes_per_lup,gbs,stream_gbs,"
+           "stream_fraction,flops_per_byte,gflops\n";
+
+    for (size_t t : threads)
+    {
+        omp_set_num_threads(static_cast<int>(t));
+        const double stream = stream_triad(size_t(1) << 25, 5);
+        std::cout << "Потоков: " << t << ", STREAM triad: " << stream << " ГБ/с\n";
+        for (size_t size : sizes)
+        {
+            const long cells = static_cast<long>(size - 2) * (size - 2);
+            const int it = static_cast<int>(std::max<long>(iterations, 100000000L / cells));
+            std::cout << "  " << size << "x" << size << " (" << 2.0 * size * size * sizeof(double) / 1048576.0
+                      << " МБ, " << it << " итераций):\n";
+            for (const SweepVariant &variant : sweep_variants(list, size, time_steps))
+            {
+                std::vector<double> grid(size * size), other(size * size);
+                initialize(grid.data(), other.data(), size);
+                if (variant.prepare)
+                    variant.prepare(grid.data(), size);
+                const auto start{bench_clock::now()};
+                variant.solve(grid.data(), other.data(), size, it);
+                const double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+                const double mlups = static_cast<double>(cells) * it / seconds / 1e6;
+                const double gbs = mlups * variant.bytes / 1e3;
+                const double intensity = 4.0 / variant.bytes;
+                std::cout << "    " << variant.name << ": " << mlups << " MLUP/s, " << gbs << " ГБ/с, "
+                          << gbs / stream * 100 << "% STREAM\n";
+                csv << variant.name << "," << t << "," << size << "," << 2 * size * size * sizeof(double) << ","
+                    << it << "," << seconds << "," << mlups << "," << variant.bytes << "," << gbs << "," << stream
+                    << "," << gbs / stream << "," << intensity << "," << mlups * 4.0 / 1e3 << "\n";
+            }
+        }
+    }
+    std::cout << "CSV: " << csv_path << "\n";
+}
+
+// Якоби на сетках со страницами 4 КБ, THP и hugetlb (без пула hugetlb
+// откатывается на THP). Первое касание — initialize(), оно меряется
+// отдельно от итераций. Доля 2 МБ — по /proc/self/smaps.
+void bench_pages(const std::vector<size_t> &sizes, int iterations)
+{
+    std::cout << "Потоков: " << omp_get_max_threads() << ", итераций: " << iterations << "\n";
+    const RowKernel kernel = row_kernel(best_isa());
+    const Pages modes[] = {Pages::Small, Pages::Transparent, Pages::HugeTlb};
+    for (size_t size : sizes)
+    {
+        std::cout << "  " << size << "x" << size << " (" << 2.0 * size * size * sizeof(double) / 1048576.0 << " МБ):\n";
+        for (Pages mode : modes)
+        {
+            AllocationOptions options;
+            options.pages = mode;
+            auto start{bench_clock::now()};
+            HugeArray<double> A(size * size, options), Anew(size * size, options);
+            initialize(A.data(), Anew.data(), size);
+            const double touch = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+            start = bench_clock::now();
+            solve_jacobi(A.data(), Anew.data(), size, kFixedIterations, iterations, false, kernel);
+            const double elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+            const double mlups = static_cast<double>(size - 2) * (size - 2) * iterations / elapsed / 1e6;
+            std::cout << "    " << pages_name(mode) << " (получено " << pages_name(A.pages()) << ", на 2 МБ "
+                      << 100.0 * A.huge_bytes() / (size * size * sizeof(double)) << "%): первое касание "
+                      << touch << " с, " << mlups << " MLUP/s\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string mode;
+    std::string sizes;
+    int iterations;
+    int time_steps;
+    double accuracy;
+    int check_interval;
+    std::string checkpoint;
+    std::string threads;
+    std::string variants;
+    std::string csv;
+    int problems;
+    ActiveTileOptions active;
+
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("mode", po::value<std::string>(&mode)->default_value("tiled"), "tiled | isa | methods | multigrid | persistent | precision | checkpoint | sweep | ensemble | active | pages")
+    ("sizes", po::value<std::string>(&sizes)->default_value("256,512,1024,2048,4096"))
+    ("iterations", po::value<int>(&iterations)->default_value(200))
+    ("accuracy", po::value<double>(&accuracy)->default_value(1e-6), "для режимов methods, multigrid, persistent, precision, ensemble и active")
+    ("check_interval", po::value<int>(&check_interval)->default_value(100), "шаг проверок для persistent и точек для checkpoint")
+    ("checkpoint", po::value<std::string>(&checkpoint)->default_value("bench.ckpt"), "файл точки для checkpoint")
+    ("threads", po::value<std::string>(&threads)->default_value(""), "числа потоков для sweep, пусто — omp_get_max_threads()")
+    ("variants", po::value<std::string>(&variants)->default_value("reference,kernel,persistent,tiled,sor,float"), "варианты для sweep")
+    ("tile", po::value<size_t>(&active.tile)->default_value(32), "сторона плитки для active")
+    ("freeze_ratio", po::value<double>(&active.freeze_ratio)->default_value(0.001), "порог заморозки в долях accuracy")
+    ("lag_ratio", po::value<double>(&active.lag_ratio)->default_value(1.0), "бюджет отставания от полного Якоби в долях accuracy")
+    ("revalidate", po::value<int>(&active.revalidate)->default_value(1000), "итераций между полными проходами")
+    ("problems", po::value<int>(&problems)->default_value(1024), "задач в ансамбле")
+    ("csv", po::value<std::string>(&csv)->default_value("roofline.csv"), "CSV для sweep")
+    ("time_steps", po::value<int>(&time_steps)->default_value(0), "шагов на блок, 0 — по размеру кэша");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (mode == "tiled")
+    {
+        check_converged(128, 1e-6, time_steps);
+        bench_tiled(parse_sizes(sizes), iterations, time_steps);
+    }
+    else if (mode == "isa")
+        bench_isa(parse_sizes(sizes), iterations);
+    else if (mode == "methods")
+        bench_methods(parse_sizes(sizes), accuracy, 1000000);
+    else if (mode == "multigrid")
+        bench_multigrid(parse_sizes(sizes), accuracy, 1024);
+    else if (mode == "precision")
+        bench_precision(parse_sizes(sizes), accuracy, 1000000);
+    else if (mode == "active")
+        bench_active(parse_sizes(sizes), accuracy, active);
+    else if (mode == "ensemble")
+        bench_ensemble(parse_sizes(sizes), problems, accuracy, 1000000);
+    else if (mode == "sweep")
+        bench_sweep(parse_sizes(sizes),
+                    threads.empty() ? std::vector<size_t>{static_cast<size_t>(omp_get_max_threads())} : parse_sizes(threads),
+                    variants, iterations, time_steps, csv);
+    else if (mode == "checkpoint")
+        bench_checkpoint(parse_sizes(sizes), iterations, check_interval, checkpoint);
+    else if (mode == "pages")
+        bench_pages(parse_sizes(sizes), iterations);
+    else if (mode == "persistent")
+        bench_persistent(parse_sizes(sizes), accuracy, check_interval);
+    else
+    {
+        std::cout << "Неизвестный режим: " << mode << "\n";
+        return 1;
+    }
+    return 0;
+}
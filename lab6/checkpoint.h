@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "stencil_kernels.h"
+
+// Контрольная точка — заголовок и сетка size x size double по строкам,
+// в порядке байт машины:
+//
+//   0   magic "JACOBI\0\1" (8 байт)
+//   8   size       uint64
+//   16  iteration  int64 — сколько итераций сделано
+//   24  error      double — ошибка на этой итерации
+//   32  сетка
+//
+// Файл пишется во временный path.tmp и переименовывается, поэтому на
+// диске всегда лежит целая точка, даже если процесс упал во время записи.
+
+struct CheckpointHeader {
+    char magic[8];
+    uint64_t size;
+    int64_t iteration;
+    double error;
+};
+
+static_assert(sizeof(CheckpointHeader) == 32, "заголовок точки должен занимать 32 байта");
+
+constexpr char kCheckpointMagic[8] = {'J', 'A', 'C', 'O', 'B', 'I', '\0', '\1'};
+
+inline void write_all(int fd, const void* data, size_t bytes, const std::string& path)
+{
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0)
+    {
+        const ssize_t written = ::write(fd, p, bytes);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("write " + path + ": " + std::strerror(errno));
+        }
+        p += written;
+        bytes -= written;
+    }
+}
+
+inline void write_checkpoint(const std::string& path, const double* A, size_t size, int iteration, double error)
+{
+    CheckpointHeader header;
+    memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+    header.size = size;
+    header.iteration = iteration;
+    header.error = error;
+
+    const std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("open " + tmp + ": " + std::strerror(errno));
+    try
+    {
+        write_all(fd, &header, sizeof(header), tmp);
+        write_all(fd, A, size * size * sizeof(double), tmp);
+        if (fdatasync(fd) != 0)
+            throw std::runtime_error("fdatasync " + tmp + ": " + std::strerror(errno));
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("rename " + tmp + ": " + std::strerror(errno));
+}
+
+// Точка, отображённая в память только для чтения.
+class MappedCheckpoint {
+public:
+    explicit MappedCheckpoint(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("fstat " + path + ": " + std::strerror(errno));
+        }
+        bytes_ = st.st_size;
+        if (bytes_ < sizeof(CheckpointHeader))
+        {
+            ::close(fd);
+            throw std::runtime_error(path + ": файл короче заголовка точки");
+        }
+        data_ = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data_ == MAP_FAILED)
+            throw std::runtime_error("mmap " + path + ": " + std::strerror(errno));
+
+        const CheckpointHeader& h = header();
+        if (memcmp(h.magic, kCheckpointMagic, sizeof(h.magic)) != 0)
+        {
+            munmap(data_, bytes_);
+            throw std::runtime_error(path + ": это не контрольная точка");
+        }
+        if (bytes_ != sizeof(CheckpointHeader) + h.size * h.size * sizeof(double))
+        {
+            munmap(data_, bytes_);
+            throw std::runtime_error(path + ": размер файла не совпадает с размером сетки");
+        }
+        madvise(data_, bytes_, MADV_SEQUENTIAL);
+    }
+
+    ~MappedCheckpoint()
+    {
+        munmap(data_, bytes_);
+    }
+
+    MappedCheckpoint(const MappedCheckpoint&) = delete;
+    MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+
+    const CheckpointHeader& header() const
+    {
+        return *static_cast<const CheckpointHeader*>(data_);
+    }
+
+    const double* grid() const
+    {
+        return reinterpret_cast<const double*>(static_cast<const char*>(data_) + sizeof(CheckpointHeader));
+    }
+
+private:
+    void* data_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+// Фоновая запись точек. Решатель только копирует сетку в снимок; если
+// предыдущий снимок ещё пишется, новый пропускается и решатель не ждёт.
+class CheckpointWriter {
+public:
+    CheckpointWriter(std::string path, size_t size) : path_(std::move(path)), size_(size), snapshot_(size * size)
+    {
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~CheckpointWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    bool offer(const double* A, int iteration, double error)
+    {
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock() || pending_ || busy_)
+        {
+            skipped_++;
+            return false;
+        }
+        take(A, iteration, error);
+        lock.unlock();
+        cv_.notify_all();
+        return true;
+    }
+
+    // Последняя точка: дожидается текущей записи и своей.
+    void write_now(const double* A, int iteration, double error)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !pending_ && !busy_; });
+        take(A, iteration, error);
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return !pending_ && !busy_; });
+    }
+
+    int written() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_;
+    }
+
+    int skipped() const
+    {
+        return skipped_;
+    }
+
+private:
+    void take(const double* A, int iteration, double error)
+    {
+        memcpy(snapshot_.data(), A, size_ * size_ * sizeof(double));
+        iteration_ = iteration;
+        error_ = error;
+        pending_ = true;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            cv_.wait(lock, [this] { return pending_ || stop_; });
+            if (!pending_)
+                return;
+            pending_ = false;
+            busy_ = true;
+            const int iteration = iteration_;
+            const double error = error_;
+            lock.unlock();
+            bool ok = true;
+            try
+            {
+                write_checkpoint(path_, snapshot_.data(), size_, iteration, error);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Контрольная точка не записана: " << e.what() << "\n";
+                ok = false;
+            }
+            lock.lock();
+            busy_ = false;
+            written_ += ok;
+            cv_.notify_all();
+        }
+    }
+
+    std::string path_;
+    size_t size_;
+    std::vector<double> snapshot_;
+    int iteration_ = 0;
+    double error_ = 0.0;
+    bool pending_ = false;
+    bool busy_ = false;
+    bool stop_ = false;
+    int written_ = 0;
+    // Меняется и читается только потоком решателя.
+    int skipped_ = 0;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+// Якоби с точками каждые interval итераций. first_iteration и first_error —
+// итерация и ошибка из точки, с которой продолжается решение после
+// --restart; max_iterations и результат считаются от начала решения. Если
+// не сделано ни одной итерации, точка не перезаписывается, а результат —
+// её же итерация и ошибка.
+SolveResult solve_jacobi_checkpointed(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                                      bool verbose, RowKernel kernel, CheckpointWriter* writer, int interval,
+                                      int first_iteration = 0,
+                                      double first_error = std::numeric_limits<double>::infinity())
+{
+    double error = first_error;
+    int iteration = first_iteration;
+    while (error > accuracy && iteration < max_iterations)
+    {
+        error = calculate_next_grid(A, Anew, size, kernel);
+        copy_matrix(A, Anew, size);
+        iteration++;
+
+        if (writer && interval > 0 && iteration % interval == 0)
+            writer->offer(A, iteration, error);
+
+        if (verbose && iteration % 10000 == 0)
+        {
+            std::cout << "Итерация: " << iteration << ", ошибка: " << error << "\n";
+        }
+    }
+    if (writer && iteration > first_iteration)
+        writer->write_now(A, iteration, error);
+    return {iteration, error};
+}
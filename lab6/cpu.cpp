@@ -1,116 +1,206 @@
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <chrono>
 #include <iomanip>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
 #include <boost/program_options.hpp>
 #include <omp.h>
+#include "grid.h"
+#include "stencil_kernels.h"
+#include "temporal_blocking.h"
+#include "red_black.h"
+#include "multigrid.h"
+#include "persistent.h"
+#include "precision.h"
+#include "checkpoint.h"
+#include "ensemble.h"
+#include "active_tiles.h"
+#include "../common/huge_pages.h"
 
 namespace po = boost::program_options;
 
-void initialize(double* A, double* Anew, size_t size) 
-{
-    memset(A, 0, size * size * sizeof(double));
-    memset(Anew, 0, size * size * sizeof(double));
-    
-    A[0] = 10.0;
-    A[size-1] = 20.0;
-    A[size*(size-1)] = 30.0;
-    A[size*size-1] = 20.0;
-    
-    double top_left = A[0];
-    double top_right = A[size-1];
-    double bottom_left = A[size*(size-1)];
-    double bottom_right = A[size*size-1];
+int main(int argc, char* argv[]) {
+    int size;
+    double accuracy;
+    int max_iterations;
+    std::string method;
+    int time_steps;
+    std::string isa_option;
+    double omega;
+    std::string cycle;
+    std::string smoother;
+    std::string check;
+    int check_interval;
+    std::string precision_option;
+    std::string checkpoint;
+    int checkpoint_interval;
+    std::string restart;
+    ActiveTileOptions active;
+    std::string pages_option;
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("size", po::value<int>(&size)->default_value(256))
+    ("accuracy", po::value<double>(&accuracy)->default_value(1e-6))
+    ("max_iterations", po::value<int>(&max_iterations)->default_value(1e+6))
+    ("method", po::value<std::string>(&method)->default_value("jacobi"), "jacobi | tiled | persistent | active | gauss_seidel | sor | multigrid")
+    ("time_steps", po::value<int>(&time_steps)->default_value(0), "шагов на блок для tiled, 0 — по размеру кэша")
+    ("isa", po::value<std::string>(&isa_option)->default_value("auto"), "auto | scalar | avx2 | avx512")
+    ("omega", po::value<double>(&omega)->default_value(0.0), "параметр релаксации для sor, 0 — оптимальный")
+    ("cycle", po::value<std::string>(&cycle)->default_value("v"), "цикл multigrid: v | f")
+    ("smoother", po::value<std::string>(&smoother)->default_value("red_black"), "сглаживатель multigrid: red_black | jacobi")
+    ("check", po::value<std::string>(&check)->default_value("every"), "проверка ошибки для persistent: every | fixed | adaptive")
+    ("check_interval", po::value<int>(&check_interval)->default_value(100), "шаг (fixed) или наибольший шаг (adaptive)")
+    ("precision", po::value<std::string>(&precision_option)->default_value("double"), "тип сетки для jacobi: double | float | float_double_error | mixed")
+    ("checkpoint", po::value<std::string>(&checkpoint)->default_value(""), "файл контрольной точки для jacobi")
+    ("checkpoint_interval", po::value<int>(&checkpoint_interval)->default_value(1000), "итераций между точками")
+    ("restart", po::value<std::string>(&restart)->default_value(""), "продолжить jacobi с контрольной точки")
+    ("tile", po::value<size_t>(&active.tile)->default_value(32), "сторона плитки для active")
+    ("freeze_ratio", po::value<double>(&active.freeze_ratio)->default_value(0.001), "порог заморозки плитки в долях accuracy")
+    ("lag_ratio", po::value<double>(&active.lag_ratio)->default_value(1.0), "бюджет отставания от полного Якоби в долях accuracy")
+    ("revalidate", po::value<int>(&active.revalidate)->default_value(1000), "итераций между полными проходами для active")
+    ("pages", po::value<std::string>(&pages_option)->default_value("thp"), "страницы сеток: 4k | thp | hugetlb");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
 
-    for (int i = 1; i < size-1; ++i) 
+    const std::vector<std::string> methods = {"jacobi", "tiled", "persistent", "active", "gauss_seidel", "sor", "multigrid"};
+    if (std::find(methods.begin(), methods.end(), method) == methods.end())
     {
-        A[i] = top_left + (top_right - top_left) * i / static_cast<double>(size-1);
-        A[size*(size-1) + i] = bottom_left + (bottom_right - bottom_left) * i / static_cast<double>(size-1);
-        
-        A[size*i] = top_left + (bottom_left - top_left) * i / static_cast<double>(size-1);
-        A[size*i + size-1] = top_right + (bottom_right - top_right) * i / static_cast<double>(size-1);
+        std::cerr << "неизвестный метод: " << method
+                  << " (jacobi | tiled | persistent | active | gauss_seidel | sor | multigrid)\n";
+        return 1;
     }
-}
 
-double calculate_next_grid(double* A, double* Anew, size_t size) {
-    double error = 0.0;
-    
-    #pragma omp parallel for reduction(max:error)
-    for (int i = 1; i < size-1; ++i) {
-        for (int j = 1; j < size-1; ++j) 
+    // Размер сетки берётся из точки, сама точка копируется после initialize().
+    std::unique_ptr<MappedCheckpoint> resume;
+    if (!restart.empty())
+    {
+        try
         {
-            Anew[i*size + j] = 0.25 * (A[(i+1)*size + j] + A[(i-1)*size + j] + 
-                                       A[i*size + j-1] + A[i*size + j+1]);
-            error = fmax(error, fabs(Anew[i*size + j] - A[i*size + j]));
+            resume = std::make_unique<MappedCheckpoint>(restart);
         }
-    }
-    
-    return error;
-}
-
-void copy_matrix(double* A, double* Anew, size_t size) 
-{
-    #pragma omp parallel for
-    for (int i = 1; i < size-1; i++) {
-        for (int j = 1; j < size-1; j++) {
-            A[i * size + j] = Anew[i * size + j];
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
         }
+        size = static_cast<int>(resume->header().size);
     }
-}
-
-void print_grid(double* A, size_t size) {
-    std::cout << "\nМатрица " << size << "x" << size << ":\n";
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            std::cout << std::fixed << std::setprecision(4) << std::setw(8) << A[i*size + j] << " ";
-        }
-        std::cout << "\n";
+    AllocationOptions allocation;
+    Isa isa;
+    Precision precision;
+    try
+    {
+        allocation.pages = parse_pages(pages_option);
+        isa = parse_isa(isa_option);
+        precision = parse_precision(precision_option);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    // Точка хранит состояние только обычного Якоби.
+    if ((resume || !checkpoint.empty()) && method != "jacobi")
+    {
+        std::cerr << "--restart и --checkpoint поддерживаются только для --method=jacobi\n";
+        return 1;
+    }
+    const bool checkpointed = resume || !checkpoint.empty();
+    // Тип сетки меняет только обычный Якоби без контрольных точек.
+    if (precision != Precision::Double && (method != "jacobi" || checkpointed))
+    {
+        std::cerr << "--precision=" << precision_name(precision)
+                  << " поддерживается только для --method=jacobi без --restart и --checkpoint\n";
+        return 1;
     }
-    std::cout << std::endl;
-}
-
-int main(int argc, char* argv[]) {
-    int size;
-    double accuracy;
-    int max_iterations;
-    po::variables_map vm;
-    po::store(po::parse_command_line(argc, argv, desc), vm);
-    po::notify(vm);
     
     std::cout << "Запуск программы (CPU версия)!\n";
     std::cout << "Размер сетки: " << size << "x" << size << "\n";
     std::cout << "Точность: " << accuracy << "\n";
-    std::cout << "Максимальное количество итераций: " << max_iterations << "\n\n";
+    std::cout << "Максимальное количество итераций: " << max_iterations << "\n";
+    const bool in_place = method == "gauss_seidel" || method == "sor" || method == "multigrid";
+    if (method == "gauss_seidel")
+        omega = 1.0;
+    else if (omega <= 0.0)
+        omega = optimal_omega(size);
+    std::cout << "Метод: " << method;
+    if (method == "multigrid")
+        std::cout << ", цикл: " << cycle << ", сглаживатель: " << smoother << "\n\n";
+    else if (in_place)
+        std::cout << ", omega: " << omega << "\n\n";
+    else if (checkpointed)
+        std::cout << ", ядро: " << isa_name(isa) << ", точка: " << (checkpoint.empty() ? "нет" : checkpoint)
+                  << " (" << checkpoint_interval << ")"
+                  << (resume ? ", продолжение с итерации " + std::to_string(resume->header().iteration) : "") << "\n\n";
+    else if (method == "jacobi" && precision != Precision::Double)
+        std::cout << ", тип сетки: " << precision_name(precision) << "\n\n";
+    else if (method == "active")
+        std::cout << ", плитка: " << active.tile << ", порог: " << active.freeze_ratio << " * accuracy, бюджет: "
+                  << active.lag_ratio << " * accuracy, полный проход каждые " << active.revalidate << "\n\n";
+    else if (method == "persistent")
+        std::cout << ", ядро: " << isa_name(isa) << ", проверка: " << check << " (" << check_interval << ")\n\n";
+    else
+        std::cout << ", ядро: " << isa_name(isa) << "\n\n";
 
-    double* A = (double*)malloc(sizeof(double) * size * size);
-    double* Anew = (double*)malloc(sizeof(double) * size * size);
+    // Методы на месте обходятся одной сеткой.
+    HugeArray<double> A_array(static_cast<size_t>(size) * size, allocation);
+    HugeArray<double> Anew_array(in_place ? 0 : static_cast<size_t>(size) * size, allocation);
+    double* A = A_array.data();
+    double* Anew = Anew_array.data();
+
+    initialize(A, in_place ? A : Anew, size);
+    if (resume)
+        memcpy(A, resume->grid(), sizeof(double) * size * size);
+    std::unique_ptr<CheckpointWriter> writer;
+    if (checkpointed && !checkpoint.empty())
+        writer = std::make_unique<CheckpointWriter>(checkpoint, size);
 
-    double error = accuracy + 1.0;
-    int iteration = 0;
-    
-    initialize(A, Anew, size);
-    
     const auto start{std::chrono::steady_clock::now()};
-    
-    while (error > accuracy && iteration < max_iterations) 
-    {
-        error = calculate_next_grid(A, Anew, size);
-        copy_matrix(A, Anew, size);
-        iteration++;
-        
-        if (iteration % 10000 == 0) 
-        {
-            std::cout << "Итерация: " << iteration << ", ошибка: " << error << "\n";
-        }
-    }
-    
+
+    MultigridOptions mg_options;
+    mg_options.cycle = cycle == "f" ? Cycle::F : Cycle::V;
+    mg_options.smoother = smoother == "jacobi" ? Smoother::Jacobi : Smoother::RedBlack;
+
+    long long cells_updated = 0;
+
+    // Для multigrid итерация — это цикл.
+    SolveResult result = method == "multigrid"
+        ? Multigrid(size, mg_options).solve(A, accuracy, max_iterations, true)
+        : in_place
+        ? solve_red_black(A, size, accuracy, max_iterations, true, omega)
+        : method == "persistent"
+        ? solve_jacobi_persistent(A, Anew, size, accuracy, max_iterations, true,
+                                  parse_check_schedule(check, check_interval), row_kernel(isa))
+        : method == "active"
+        ? solve_jacobi_active(A, Anew, size, accuracy, max_iterations, true, active, &cells_updated)
+        : method == "tiled"
+        ? solve_jacobi_tiled(A, Anew, size, accuracy, max_iterations, true, time_steps, row_kernel(isa))
+        : checkpointed
+        ? solve_jacobi_checkpointed(A, Anew, size, accuracy, max_iterations, true, row_kernel(isa), writer.get(),
+                                    checkpoint_interval, resume ? static_cast<int>(resume->header().iteration) : 0,
+                                    resume ? resume->header().error : std::numeric_limits<double>::infinity())
+        : precision != Precision::Double
+        ? solve_jacobi_precision(A, Anew, size, accuracy, max_iterations, true, precision)
+        : solve_jacobi(A, Anew, size, accuracy, max_iterations, true, row_kernel(isa));
+
     const auto end{std::chrono::steady_clock::now()};
     const std::chrono::duration<double> elapsed_seconds{end - start};
 
     std::cout << "\nРезультаты:\n";
     std::cout << "Время выполнения: " << elapsed_seconds.count() << " секунд\n";
-    std::cout << "Количество итераций: " << iteration << "\n";
-    std::cout << "Конечная ошибка: " << error << "\n";
+    std::cout << "Количество итераций: " << result.iterations << "\n";
+    std::cout << "Конечная ошибка: " << result.error << "\n";
+    if (method == "active")
+        std::cout << "Клеток за итерацию: " << cells_updated / std::max(1, result.iterations) << " из "
+                  << (size - 2) * (size - 2) << "\n";
+    if (writer)
+        std::cout << "Контрольных точек записано: " << writer->written() << ", пропущено: " << writer->skipped() << "\n";
     
     if (size == 10 || size == 13) 
     {
@@ -118,40 +208,12 @@ int main(int argc, char* argv[]) {
     } 
     else 
     {
-        double* A_10 = (double*)malloc(10 * 10 * sizeof(double));
-        double* Anew_10 = (double*)malloc(10 * 10 * sizeof(double));
-        double* A_13 = (double*)malloc(13 * 13 * sizeof(double));
-        double* Anew_13 = (double*)malloc(13 * 13 * sizeof(double));
-        
-        initialize(A_10, Anew_10, 10);
-        initialize(A_13, Anew_13, 13);
-        
-        error = accuracy + 1.0;
-        iteration = 0;
-        while (error > accuracy && iteration < max_iterations) {
-            error = calculate_next_grid(A_10, Anew_10, 10);
-            copy_matrix(A_10, Anew_10, 10);
-            iteration++;
-        }
-        print_grid(A_10, 10);
-        
-        error = accuracy + 1.0;
-        iteration = 0;
-        while (error > accuracy && iteration < max_iterations) {
-            error = calculate_next_grid(A_13, Anew_13, 13);
-            copy_matrix(A_13, Anew_13, 13);
-            iteration++;
-        }
-        print_grid(A_13, 13);
-        
-        free(A_10);
-        free(Anew_10);
-        free(A_13);
-        free(Anew_13);
+        // Обе сетки решаются одновременно, каждая одним потоком.
+        std::vector<std::vector<double>> grids;
+        solve_ensemble({{10, {}}, {13, {}}}, accuracy, max_iterations, grids);
+        print_grid(grids[0].data(), 10);
+        print_grid(grids[1].data(), 13);
     }
     
-    free(A);
-    free(Anew);
-    
     return 0;
 }
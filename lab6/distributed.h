@@ -0,0 +1,227 @@
+#pragma once
+
+#include <mpi.h>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "grid.h"
+
+// Якоби на двумерной решётке MPI-процессов. Внутренние строки и столбцы
+// сетки size x size делятся на py x px почти равных блоков. У блока
+// rows x cols есть рамка шириной в одну клетку: со стороны соседа это
+// теневые клетки (его крайние строка или столбец), со стороны границы —
+// неизменная граница из initialize(). Шаблон и порядок сложений те же,
+// что в calculate_next_grid, а максимум от порядка не зависит, поэтому
+// сетка и число итераций совпадают с OpenMP-версией побитно.
+
+// Значение клетки (i, j) после initialize(): те же выражения, что там.
+inline double initial_value(size_t i, size_t j, size_t size)
+{
+    const double top_left = 10.0;
+    const double top_right = 20.0;
+    const double bottom_left = 30.0;
+    const double bottom_right = 20.0;
+    const double last = static_cast<double>(size-1);
+
+    if (i == 0)
+        return j == 0 ? top_left : j == size-1 ? top_right : top_left + (top_right - top_left) * j / last;
+    if (i == size-1)
+        return j == 0 ? bottom_left : j == size-1 ? bottom_right : bottom_left + (bottom_right - bottom_left) * j / last;
+    if (j == 0)
+        return top_left + (bottom_left - top_left) * i / last;
+    if (j == size-1)
+        return top_right + (bottom_right - top_right) * i / last;
+    return 0.0;
+}
+
+// Доля part из parts для n внутренних строк (столбцов): первая строка
+// в глобальной нумерации (от 1) и их число.
+inline std::pair<size_t, size_t> split_range(size_t n, int parts, int part)
+{
+    const size_t base = n / parts;
+    const size_t extra = n % parts;
+    const size_t begin = 1 + part * base + std::min<size_t>(part, extra);
+    return {begin, base + (static_cast<size_t>(part) < extra ? 1 : 0)};
+}
+
+class DistributedGrid {
+public:
+    // px x py = 0 x 0 — решётку выбирает MPI_Dims_create.
+    DistributedGrid(MPI_Comm comm, size_t size, int px = 0, int py = 0) : size_(size)
+    {
+        int ranks;
+        MPI_Comm_size(comm, &ranks);
+        dims_[0] = py;
+        dims_[1] = px;
+        MPI_Dims_create(ranks, 2, dims_);
+        const int periods[2] = {0, 0};
+        MPI_Cart_create(comm, 2, dims_, periods, 0, &cart_);
+        MPI_Comm_rank(cart_, &rank_);
+        MPI_Cart_coords(cart_, rank_, 2, coords_);
+        MPI_Cart_shift(cart_, 0, 1, &up_, &down_);
+        MPI_Cart_shift(cart_, 1, 1, &left_, &right_);
+
+        std::tie(row0_, rows_) = split_range(size - 2, dims_[0], coords_[0]);
+        std::tie(col0_, cols_) = split_range(size - 2, dims_[1], coords_[1]);
+        stride_ = cols_ + 2;
+
+        MPI_Type_vector(static_cast<int>(rows_), 1, static_cast<int>(stride_), MPI_DOUBLE, &column_);
+        MPI_Type_commit(&column_);
+
+        // Рамка в обоих буферах одинакова: вне обмена её меняют только соседи.
+        a_.resize((rows_ + 2) * stride_);
+        for (size_t i = 0; i < rows_ + 2; ++i)
+            for (size_t j = 0; j < stride_; ++j)
+                a_[i*stride_ + j] = initial_value(row0_ - 1 + i, col0_ - 1 + j, size);
+        b_ = a_;
+    }
+
+    ~DistributedGrid()
+    {
+        MPI_Type_free(&column_);
+        MPI_Comm_free(&cart_);
+    }
+
+    DistributedGrid(const DistributedGrid&) = delete;
+    DistributedGrid& operator=(const DistributedGrid&) = delete;
+
+    int rank() const { return rank_; }
+    int px() const { return dims_[1]; }
+    int py() const { return dims_[0]; }
+    MPI_Comm comm() const { return cart_; }
+
+    // Байты двух буферов этого процесса.
+    size_t local_bytes() const
+    {
+        return 2 * (rows_ + 2) * stride_ * sizeof(double);
+    }
+
+    // Обмен рамкой идёт, пока считается внутренность блока; края
+    // досчитываются после MPI_Waitall. Ошибка — MPI_Allreduce на каждой
+    // итерации, как у solve_jacobi.
+    SolveResult solve(double accuracy, int max_iterations, bool verbose)
+    {
+        double error = accuracy + 1.0;
+        int iteration = 0;
+        while (error > accuracy && iteration < max_iterations)
+        {
+            double* src = current();
+            double* dst = next();
+
+            MPI_Request requests[8];
+            post_halo(src, requests);
+
+            double local = 0.0;
+            if (rows_ > 2 && cols_ > 2)
+                local = update(src, dst, 2, rows_ - 1, 2, cols_ - 1);
+
+            MPI_Waitall(8, requests, MPI_STATUSES_IGNORE);
+
+            local = std::max(local, update(src, dst, 1, 1, 1, cols_));
+            if (rows_ > 1)
+                local = std::max(local, update(src, dst, rows_, rows_, 1, cols_));
+            if (rows_ > 2)
+            {
+                local = std::max(local, update(src, dst, 2, rows_ - 1, 1, 1));
+                if (cols_ > 1)
+                    local = std::max(local, update(src, dst, 2, rows_ - 1, cols_, cols_));
+            }
+
+            MPI_Allreduce(&local, &error, 1, MPI_DOUBLE, MPI_MAX, cart_);
+            flipped_ = !flipped_;
+            iteration++;
+
+            if (verbose && rank_ == 0 && iteration % 10000 == 0)
+            {
+                std::cout << "Итерация: " << iteration << ", ошибка: " << error << "\n";
+            }
+        }
+        return {iteration, error};
+    }
+
+    // Собирает сетку size x size в A на процессе 0; вызывается всеми.
+    void gather(double* A) const
+    {
+        const double* src = current();
+        std::vector<double> block(rows_ * cols_);
+        for (size_t i = 0; i < rows_; ++i)
+            std::copy_n(src + (i + 1) * stride_ + 1, cols_, block.data() + i * cols_);
+
+        if (rank_ != 0)
+        {
+            MPI_Send(block.data(), static_cast<int>(block.size()), MPI_DOUBLE, 0, 0, cart_);
+            return;
+        }
+
+        for (size_t i = 0; i < size_; ++i)
+            for (size_t j = 0; j < size_; ++j)
+                A[i*size_ + j] = initial_value(i, j, size_);
+
+        const int ranks = dims_[0] * dims_[1];
+        for (int r = 0; r < ranks; ++r)
+        {
+            int coords[2];
+            MPI_Cart_coords(cart_, r, 2, coords);
+            const auto [row0, rows] = split_range(size_ - 2, dims_[0], coords[0]);
+            const auto [col0, cols] = split_range(size_ - 2, dims_[1], coords[1]);
+            std::vector<double> part(rows * cols);
+            if (r == 0)
+                part = block;
+            else
+                MPI_Recv(part.data(), static_cast<int>(part.size()), MPI_DOUBLE, r, 0, cart_, MPI_STATUS_IGNORE);
+            for (size_t i = 0; i < rows; ++i)
+                std::copy_n(part.data() + i * cols, cols, A + (row0 + i) * size_ + col0);
+        }
+    }
+
+private:
+    double* current() { return flipped_ ? b_.data() : a_.data(); }
+    const double* current() const { return flipped_ ? b_.data() : a_.data(); }
+    double* next() { return flipped_ ? a_.data() : b_.data(); }
+
+    // Крайние строки и столбцы блока уходят соседям, их — в рамку src.
+    // С MPI_PROC_NULL обмен пустой, и в рамке остаётся граница.
+    void post_halo(double* src, MPI_Request* requests)
+    {
+        const int n = static_cast<int>(cols_);
+        MPI_Irecv(src + 1, n, MPI_DOUBLE, up_, 0, cart_, &requests[0]);
+        MPI_Irecv(src + (rows_ + 1) * stride_ + 1, n, MPI_DOUBLE, down_, 1, cart_, &requests[1]);
+        MPI_Irecv(src + stride_, 1, column_, left_, 2, cart_, &requests[2]);
+        MPI_Irecv(src + stride_ + cols_ + 1, 1, column_, right_, 3, cart_, &requests[3]);
+        MPI_Isend(src + stride_ + 1, n, MPI_DOUBLE, up_, 1, cart_, &requests[4]);
+        MPI_Isend(src + rows_ * stride_ + 1, n, MPI_DOUBLE, down_, 0, cart_, &requests[5]);
+        MPI_Isend(src + stride_ + 1, 1, column_, left_, 3, cart_, &requests[6]);
+        MPI_Isend(src + stride_ + cols_, 1, column_, right_, 2, cart_, &requests[7]);
+    }
+
+    // Строки i0..i1 и столбцы j0..j1 блока (включительно, нумерация с 1).
+    double update(const double* src, double* dst, size_t i0, size_t i1, size_t j0, size_t j1) const
+    {
+        const size_t s = stride_;
+        double error = 0.0;
+
+        #pragma omp parallel for reduction(max:error)
+        for (long i = static_cast<long>(i0); i <= static_cast<long>(i1); ++i)
+        {
+            for (size_t j = j0; j <= j1; ++j)
+            {
+                dst[i*s + j] = 0.25 * (src[(i+1)*s + j] + src[(i-1)*s + j] + src[i*s + j-1] + src[i*s + j+1]);
+                error = fmax(error, fabs(dst[i*s + j] - src[i*s + j]));
+            }
+        }
+        return error;
+    }
+
+    size_t size_;
+    int dims_[2];
+    int coords_[2];
+    int rank_ = 0;
+    int up_, down_, left_, right_;
+    MPI_Comm cart_;
+    MPI_Datatype column_;
+    size_t row0_, rows_, col0_, cols_, stride_;
+    std::vector<double> a_, b_;
+    bool flipped_ = false;
+};
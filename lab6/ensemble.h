@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+#include "stencil_kernels.h"
+
+// Ансамбль маленьких задач: много сеток с разными граничными условиями.
+// Параллелизм — между задачами, а не внутри сетки: каждая задача (или
+// пачка) целиком решается одним потоком, без fork/join на итерацию.
+//
+// Задачи одного размера до packed_max_size собираются в пачки по
+// kEnsembleLanes: клетка (i, j) всех задач пачки лежит подряд, и шаг
+// Якоби векторизуется по задачам, а не по строке из 8-11 клеток.
+// Каждая задача в пачке останавливается на своей итерации: её значения
+// дальше только переносятся, поэтому сетка и число итераций у каждой
+// задачи побитно те же, что у solve_jacobi.
+
+struct GridProblem {
+    size_t size;
+    Corners corners;
+};
+
+constexpr size_t kEnsembleLanes = 8;
+// С 32x32 строка уже достаточно длинная для векторного ядра строки, и
+// задача на поток быстрее пачки (см. bench --mode=ensemble).
+constexpr size_t kEnsemblePackedMaxSize = 24;
+
+// Одна задача одним потоком: буферы меняются местами, итог — в A.
+inline SolveResult solve_jacobi_serial(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                                       RowKernel kernel)
+{
+    double* src = A;
+    double* dst = Anew;
+    double error = accuracy + 1.0;
+    int iteration = 0;
+    while (error > accuracy && iteration < max_iterations)
+    {
+        error = 0.0;
+        for (size_t i = 1; i < size-1; ++i)
+            error = fmax(error, kernel(src, dst, size, i));
+        std::swap(src, dst);
+        iteration++;
+    }
+    if (src != A)
+        memcpy(A, src, size * size * sizeof(double));
+    return {iteration, error};
+}
+
+// Пачка из count <= kEnsembleLanes задач размера size. Пустые дорожки
+// неактивны с самого начала.
+inline void solve_packed(const std::vector<GridProblem>& problems, const size_t* indices, size_t count, size_t size,
+                         double accuracy, int max_iterations, std::vector<std::vector<double>>& grids,
+                         std::vector<SolveResult>& results)
+{
+    constexpr size_t W = kEnsembleLanes;
+    const size_t cells = size * size;
+    std::vector<double> packed(cells * W), other(cells * W), grid(cells), unused(cells);
+
+    bool active[W] = {};
+    int iterations[W] = {};
+    double errors[W];
+    for (size_t l = 0; l < W; ++l)
+    {
+        errors[l] = accuracy + 1.0;
+        if (l < count)
+        {
+            initialize(grid.data(), unused.data(), size, problems[indices[l]].corners);
+            active[l] = max_iterations > 0;
+        }
+        for (size_t k = 0; k < cells; ++k)
+            packed[k*W + l] = l < count ? grid[k] : 0.0;
+    }
+    // Граница в обоих буферах одинакова.
+    other = packed;
+
+    double* src = packed.data();
+    double* dst = other.data();
+    const size_t row = size * W;
+    bool any = std::any_of(active, active + W, [](bool a) { return a; });
+    while (any)
+    {
+        double lane_error[W] = {};
+        for (size_t i = 1; i < size-1; ++i)
+        {
+            for (size_t j = 1; j < size-1; ++j)
+            {
+                const double* c = src + (i*size + j) * W;
+                const double* up = c - row;
+                const double* down = c + row;
+                const double* left = c - W;
+                const double* right = c + W;
+                double* out = dst + (i*size + j) * W;
+                #pragma omp simd
+                for (size_t l = 0; l < W; ++l)
+                {
+                    const double value = 0.25 * (down[l] + up[l] + left[l] + right[l]);
+                    const double change = active[l] ? std::fabs(value - c[l]) : 0.0;
+                    out[l] = active[l] ? value : c[l];
+                    lane_error[l] = change > lane_error[l] ? change : lane_error[l];
+                }
+            }
+        }
+        std::swap(src, dst);
+
+        any = false;
+        for (size_t l = 0; l < W; ++l)
+        {
+            if (!active[l])
+                continue;
+            errors[l] = lane_error[l];
+            iterations[l]++;
+            active[l] = errors[l] > accuracy && iterations[l] < max_iterations;
+            any = any || active[l];
+        }
+    }
+
+    for (size_t l = 0; l < count; ++l)
+    {
+        std::vector<double>& out = grids[indices[l]];
+        out.resize(cells);
+        for (size_t k = 0; k < cells; ++k)
+            out[k] = src[k*W + l];
+        results[indices[l]] = {iterations[l], errors[l]};
+    }
+}
+
+// grids[k] — решённая сетка задачи k. packed_max_size = 0 отключает пачки.
+std::vector<SolveResult> solve_ensemble(const std::vector<GridProblem>& problems, double accuracy, int max_iterations,
+                                        std::vector<std::vector<double>>& grids,
+                                        size_t packed_max_size = kEnsemblePackedMaxSize)
+{
+    std::vector<SolveResult> results(problems.size());
+    grids.resize(problems.size());
+
+    // Работа — одна задача или пачка одного размера.
+    std::map<size_t, std::vector<size_t>> by_size;
+    for (size_t k = 0; k < problems.size(); ++k)
+        by_size[problems[k].size].push_back(k);
+    std::vector<std::pair<const size_t*, size_t>> work;
+    for (const auto& [size, indices] : by_size)
+    {
+        const bool pack = size <= packed_max_size && indices.size() > 1;
+        const size_t step = pack ? kEnsembleLanes : 1;
+        for (size_t first = 0; first < indices.size(); first += step)
+            work.push_back({indices.data() + first, std::min(step, indices.size() - first)});
+    }
+
+    const RowKernel kernel = row_kernel(best_isa());
+    #pragma omp parallel for schedule(dynamic)
+    for (long w = 0; w < static_cast<long>(work.size()); ++w)
+    {
+        const auto [indices, count] = work[w];
+        const size_t size = problems[indices[0]].size;
+        if (count > 1)
+        {
+            solve_packed(problems, indices, count, size, accuracy, max_iterations, grids, results);
+            continue;
+        }
+        std::vector<double>& A = grids[indices[0]];
+        A.resize(size * size);
+        std::vector<double> Anew(size * size);
+        initialize(A.data(), Anew.data(), size, problems[indices[0]].corners);
+        memcpy(Anew.data(), A.data(), size * size * sizeof(double));
+        results[indices[0]] = solve_jacobi_serial(A.data(), Anew.data(), size, accuracy, max_iterations, kernel);
+    }
+    return results;
+}
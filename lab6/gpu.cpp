@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cmath>
+#include <cstring>
 #include <chrono>
 #include <iomanip>
 #include <boost/program_options.hpp>
@@ -36,8 +37,10 @@ double calculate_next_grid(double* A, double* Anew, size_t size, bool check_erro
     
     if (check_error) {
         #pragma acc parallel loop reduction(max:error) present(A,Anew)
+        #pragma omp parallel for reduction(max:error)
         for (int i = 1; i < size-1; ++i) {
             #pragma acc loop
+            #pragma omp simd reduction(max:error)
             for (int j = 1; j < size-1; ++j) {
                 Anew[i*size + j] = 0.25 * (A[(i+1)*size + j] + A[(i-1)*size + j] + 
                                            A[i*size + j-1] + A[i*size + j+1]);
@@ -47,8 +50,10 @@ double calculate_next_grid(double* A, double* Anew, size_t size, bool check_erro
     }
     else {
         #pragma acc parallel loop present(A,Anew)
+        #pragma omp parallel for
         for (int i = 1; i < size-1; ++i) {
             #pragma acc loop
+            #pragma omp simd
             for (int j = 1; j < size-1; ++j) {
                 Anew[i*size + j] = 0.25 * (A[(i+1)*size + j] + A[(i-1)*size + j] + 
                                          A[i*size + j-1] + A[i*size + j+1]);
@@ -61,8 +66,10 @@ double calculate_next_grid(double* A, double* Anew, size_t size, bool check_erro
 
 void copy_matrix(double* A, double* Anew, size_t size) {
     #pragma acc parallel loop present(A,Anew)
+    #pragma omp parallel for
     for (int i = 1; i < size-1; i++) {
         #pragma acc loop
+        #pragma omp simd
         for (int j = 1; j < size-1; j++) {
             A[i * size + j] = Anew[i * size + j];
         }
@@ -92,11 +99,21 @@ int main(int argc, char* argv[]) {
     int size;
     double accuracy;
     int max_iterations;
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("size", po::value<int>(&size)->default_value(256))
+    ("accuracy", po::value<double>(&accuracy)->default_value(1e-6))
+    ("max_iterations", po::value<int>(&max_iterations)->default_value(1e+6));
+
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
     
+#if defined(_OPENACC)
     std::cout << "Запуск программы (GPU версия)!\n";
+#else
+    std::cout << "Запуск программы (OpenMP сборка GPU версии)!\n";
+#endif
     std::cout << "Размер сетки: " << size << "x" << size << "\n";
     std::cout << "Точность: " << accuracy << "\n";
     std::cout << "Максимальное количество итераций: " << max_iterations << "\n\n";
@@ -133,6 +150,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Время выполнения: " << elapsed_seconds.count() << " секунд\n";
     std::cout << "Количество итераций: " << iteration << "\n";
     std::cout << "Конечная ошибка: " << error << "\n";
+    std::cout << "Скорость: " << static_cast<double>(size - 2) * (size - 2) * iteration / elapsed_seconds.count() / 1e6
+              << " MLUP/s\n";
     
     if (size == 10 || size == 13) {
         print_grid(A, size);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <omp.h>
+
+// Сетка size x size, граница задаётся initialize() и не меняется.
+// A — текущая итерация, Anew — следующая.
+
+struct SolveResult {
+    int iterations;
+    double error;
+};
+
+// Значения в углах; по сторонам граница интерполируется линейно.
+struct Corners {
+    double top_left = 10.0;
+    double top_right = 20.0;
+    double bottom_left = 30.0;
+    double bottom_right = 20.0;
+};
+
+void initialize(double* A, double* Anew, size_t size, Corners corners = {})
+{
+    memset(A, 0, size * size * sizeof(double));
+    memset(Anew, 0, size * size * sizeof(double));
+
+    A[0] = corners.top_left;
+    A[size-1] = corners.top_right;
+    A[size*(size-1)] = corners.bottom_left;
+    A[size*size-1] = corners.bottom_right;
+
+    double top_left = A[0];
+    double top_right = A[size-1];
+    double bottom_left = A[size*(size-1)];
+    double bottom_right = A[size*size-1];
+
+    for (int i = 1; i < size-1; ++i)
+    {
+        A[i] = top_left + (top_right - top_left) * i / static_cast<double>(size-1);
+        A[size*(size-1) + i] = bottom_left + (bottom_right - bottom_left) * i / static_cast<double>(size-1);
+
+        A[size*i] = top_left + (bottom_left - top_left) * i / static_cast<double>(size-1);
+        A[size*i + size-1] = top_right + (bottom_right - top_right) * i / static_cast<double>(size-1);
+    }
+}
+
+double calculate_next_grid(double* A, double* Anew, size_t size) {
+    double error = 0.0;
+
+    #pragma omp parallel for reduction(max:error)
+    for (int i = 1; i < size-1; ++i) {
+        for (int j = 1; j < size-1; ++j)
+        {
+            Anew[i*size + j] = 0.25 * (A[(i+1)*size + j] + A[(i-1)*size + j] +
+                                       A[i*size + j-1] + A[i*size + j+1]);
+            error = fmax(error, fabs(Anew[i*size + j] - A[i*size + j]));
+        }
+    }
+
+    return error;
+}
+
+void copy_matrix(double* A, double* Anew, size_t size)
+{
+    #pragma omp parallel for
+    for (int i = 1; i < size-1; i++) {
+        for (int j = 1; j < size-1; j++) {
+            A[i * size + j] = Anew[i * size + j];
+        }
+    }
+}
+
+void print_grid(double* A, size_t size) {
+    std::cout << "\nМатрица " << size << "x" << size << ":\n";
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            std::cout << std::fixed << std::setprecision(4) << std::setw(8) << A[i*size + j] << " ";
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::endl;
+}
+
+// Цикл до точности; step(A, Anew, size) делает шаг в Anew и возвращает ошибку.
+template<typename Step>
+SolveResult jacobi_loop(double* A, double* Anew, size_t size, double accuracy, int max_iterations, bool verbose,
+                        Step step)
+{
+    double error = accuracy + 1.0;
+    int iteration = 0;
+    while (error > accuracy && iteration < max_iterations)
+    {
+        error = step(A, Anew, size);
+        copy_matrix(A, Anew, size);
+        iteration++;
+
+        if (verbose && iteration % 10000 == 0)
+        {
+            std::cout << "Итерация: " << iteration << ", ошибка: " << error << "\n";
+        }
+    }
+    return {iteration, error};
+}
+
+// Исходный цикл: пересчёт и копирование на каждой итерации.
+SolveResult solve_jacobi(double* A, double* Anew, size_t size, double accuracy, int max_iterations, bool verbose)
+{
+    return jacobi_loop(A, Anew, size, accuracy, max_iterations, verbose,
+                       [](double* a, double* anew, size_t n) { return calculate_next_grid(a, anew, n); });
+}
@@ -0,0 +1,184 @@
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <mpi.h>
+#include <omp.h>
+#include "grid.h"
+#include "distributed.h"
+
+namespace po = boost::program_options;
+
+// Сильная масштабируемость: сетка size x size на 1, 2, 4, ... процессах
+// из запущенных (остальные ждут). Фиксированное число итераций, как в bench.
+void bench_strong(size_t size, int iterations)
+{
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    if (rank == 0)
+        std::cout << "Сильная масштабируемость: " << size << "x" << size << ", итераций: " << iterations
+                  << ", потоков на процесс: " << omp_get_max_threads() << "\n";
+
+    double base = 0.0;
+    for (int p = 1; p <= ranks; p = p < ranks && p * 2 > ranks ? ranks : p * 2)
+    {
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+        if (comm != MPI_COMM_NULL)
+        {
+            DistributedGrid grid(comm, size);
+            MPI_Barrier(comm);
+            const double start = MPI_Wtime();
+            grid.solve(0.0, iterations, false);
+            const double elapsed = MPI_Wtime() - start;
+            if (rank == 0)
+            {
+                if (p == 1)
+                    base = elapsed;
+                const double mlups = static_cast<double>(size - 2) * (size - 2) * iterations / elapsed / 1e6;
+                std::cout << "  " << p << " (" << grid.py() << "x" << grid.px() << "): " << elapsed << " с, "
+                          << mlups << " MLUP/s, ускорение " << base / elapsed << ", эффективность "
+                          << base / elapsed / p << ", на процесс " << grid.local_bytes() / 1048576.0 << " МБ\n";
+            }
+            MPI_Comm_free(&comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (p == ranks)
+            break;
+    }
+}
+
+// Слабая масштабируемость: около local_size x local_size внутренних
+// клеток на процесс, сторона сетки растёт как sqrt(p). Сетка целиком
+// на больших p не помещается ни в один процесс: её размер печатается
+// рядом с памятью одного процесса.
+void bench_weak(size_t local_size, int iterations)
+{
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    if (rank == 0)
+        std::cout << "Слабая масштабируемость: " << local_size << "x" << local_size << " на процесс, итераций: "
+                  << iterations << ", потоков на процесс: " << omp_get_max_threads() << "\n";
+
+    double base = 0.0;
+    for (int p = 1; p <= ranks; p = p < ranks && p * 2 > ranks ? ranks : p * 2)
+    {
+        const size_t size = static_cast<size_t>(std::lround(local_size * std::sqrt(static_cast<double>(p)))) + 2;
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+        if (comm != MPI_COMM_NULL)
+        {
+            DistributedGrid grid(comm, size);
+            MPI_Barrier(comm);
+            const double start = MPI_Wtime();
+            grid.solve(0.0, iterations, false);
+            const double elapsed = MPI_Wtime() - start;
+            if (rank == 0)
+            {
+                if (p == 1)
+                    base = elapsed;
+                const double mlups = static_cast<double>(size - 2) * (size - 2) * iterations / elapsed / 1e6;
+                std::cout << "  " << p << " (" << grid.py() << "x" << grid.px() << "), сетка " << size << "x" << size
+                          << ": " << elapsed << " с, " << mlups << " MLUP/s, эффективность " << base / elapsed
+                          << ", сетка целиком " << 2.0 * size * size * sizeof(double) / 1048576.0
+                          << " МБ, на процесс " << grid.local_bytes() / 1048576.0 << " МБ\n";
+            }
+            MPI_Comm_free(&comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (p == ranks)
+            break;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    int size;
+    double accuracy;
+    int max_iterations;
+    int px, py;
+    std::string mode;
+    bool verify;
+    int iterations;
+    int local_size;
+    po::options_description desc("Опции");
+    desc.add_options()
+    ("size", po::value<int>(&size)->default_value(256))
+    ("accuracy", po::value<double>(&accuracy)->default_value(1e-6))
+    ("max_iterations", po::value<int>(&max_iterations)->default_value(1e+6))
+    ("px", po::value<int>(&px)->default_value(0), "процессов по столбцам, 0 — MPI_Dims_create")
+    ("py", po::value<int>(&py)->default_value(0), "процессов по строкам, 0 — MPI_Dims_create")
+    ("mode", po::value<std::string>(&mode)->default_value("solve"), "solve | strong | weak")
+    ("verify", po::bool_switch(&verify), "сравнить сетку с OpenMP-версией (solve_jacobi) на процессе 0")
+    ("iterations", po::value<int>(&iterations)->default_value(200), "итераций для strong и weak")
+    ("local_size", po::value<int>(&local_size)->default_value(1024), "сторона блока процесса для weak");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (mode == "strong")
+        bench_strong(size, iterations);
+    else if (mode == "weak")
+        bench_weak(local_size, iterations);
+    else
+    {
+        DistributedGrid grid(MPI_COMM_WORLD, size, px, py);
+        if (size - 2 < std::max(grid.px(), grid.py()))
+        {
+            if (rank == 0)
+                std::cerr << "Внутренних строк меньше, чем процессов по стороне решётки\n";
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (rank == 0)
+        {
+            std::cout << "Запуск программы (MPI версия)!\n";
+            std::cout << "Размер сетки: " << size << "x" << size << "\n";
+            std::cout << "Точность: " << accuracy << "\n";
+            std::cout << "Максимальное количество итераций: " << max_iterations << "\n";
+            std::cout << "Процессов: " << ranks << " (" << grid.py() << "x" << grid.px() << "), потоков на процесс: "
+                      << omp_get_max_threads() << "\n\n";
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        const double start = MPI_Wtime();
+        SolveResult result = grid.solve(accuracy, max_iterations, true);
+        const double elapsed = MPI_Wtime() - start;
+
+        std::vector<double> A(rank == 0 ? static_cast<size_t>(size) * size : 0);
+        grid.gather(A.data());
+
+        if (rank == 0)
+        {
+            std::cout << "\nРезультаты:\n";
+            std::cout << "Время выполнения: " << elapsed << " секунд\n";
+            std::cout << "Количество итераций: " << result.iterations << "\n";
+            std::cout << "Конечная ошибка: " << result.error << "\n";
+
+            if (verify)
+            {
+                std::vector<double> reference(A.size()), other(A.size());
+                initialize(reference.data(), other.data(), size);
+                SolveResult expected = solve_jacobi(reference.data(), other.data(), size, accuracy, max_iterations,
+                                                    false);
+                const bool same = memcmp(A.data(), reference.data(), A.size() * sizeof(double)) == 0;
+                std::cout << "OpenMP-версия: " << expected.iterations << " итераций, сетка "
+                          << (same && expected.iterations == result.iterations ? "совпадает" : "ОТЛИЧАЕТСЯ") << "\n";
+            }
+
+            if (size == 10 || size == 13)
+                print_grid(A.data(), size);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
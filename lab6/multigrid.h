@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "grid.h"
+
+// Геометрический многосеточный метод для той же задачи, что и у Якоби:
+// уравнение Лапласа с границей из initialize(). На каждом уровне решается
+// (4u - сумма соседей) / h^2 = f, на грубых уровнях f — сжатая невязка.
+//
+// Число интервалов m огрубляется как m -> ceil(m / 2), поэтому подходит
+// любой size (у 2^k - 1 интервалов стандартное огрубление вдвое не
+// работает). Коэффициент между уровнями r = m_fine / m_coarse лежит в (1, 2];
+// продолжение — билинейная интерполяция, сжатие — транспонированное
+// продолжение, делённое на r^2 (при r = 2 это полное взвешивание).
+//
+// Ошибка цикла — максимальное изменение сетки за цикл, аналог изменения
+// за проход у Якоби.
+
+enum class Cycle { V, F };
+enum class Smoother { Jacobi, RedBlack };
+
+struct MultigridOptions {
+    Cycle cycle = Cycle::V;
+    Smoother smoother = Smoother::RedBlack;
+    int pre_sweeps = 2;
+    int post_sweeps = 2;
+};
+
+class Multigrid {
+public:
+    Multigrid(size_t size, MultigridOptions options) : options_(options)
+    {
+        size_t m = size - 1;
+        double h = 1.0;
+        while (true)
+        {
+            Level level;
+            level.n = m + 1;
+            level.h2 = h * h;
+            levels_.push_back(std::move(level));
+            if (m <= kCoarsestIntervals)
+                break;
+            const size_t coarse = (m + 1) / 2;
+            h *= static_cast<double>(m) / coarse;
+            m = coarse;
+        }
+
+        for (size_t l = 0; l < levels_.size(); ++l)
+        {
+            Level& level = levels_[l];
+            const size_t cells = level.n * level.n;
+            if (l > 0)
+            {
+                level.storage.assign(cells, 0.0);
+                level.u = level.storage.data();
+                level.f.assign(cells, 0.0);
+            }
+            if (l + 1 < levels_.size())
+            {
+                level.r.assign(cells, 0.0);
+                build_transfer(level, levels_[l + 1]);
+            }
+            if (options_.smoother == Smoother::Jacobi)
+                level.tmp.assign(cells, 0.0);
+        }
+        previous_.resize(size * size);
+    }
+
+    size_t levels() const
+    {
+        return levels_.size();
+    }
+
+    // A — сетка size x size с границей; внутренность — начальное приближение.
+    SolveResult solve(double* A, double accuracy, int max_cycles, bool verbose)
+    {
+        Level& fine = levels_[0];
+        fine.u = A;
+        const size_t cells = fine.n * fine.n;
+
+        double error = accuracy + 1.0;
+        int cycle = 0;
+        while (error > accuracy && cycle < max_cycles)
+        {
+            memcpy(previous_.data(), A, cells * sizeof(double));
+            if (options_.cycle == Cycle::F)
+                f_cycle(0);
+            else
+                v_cycle(0);
+            cycle++;
+
+            error = 0.0;
+            #pragma omp parallel for reduction(max:error)
+            for (long k = 0; k < static_cast<long>(cells); ++k)
+                error = fmax(error, fabs(A[k] - previous_[k]));
+
+            if (verbose)
+            {
+                std::cout << "Цикл: " << cycle << ", ошибка: " << error << "\n";
+            }
+        }
+        return {cycle, error};
+    }
+
+private:
+    static constexpr size_t kCoarsestIntervals = 4;
+
+    // Веса одной координаты: сжатие собирает до 4 точек мелкой сетки,
+    // продолжение берёт 2 соседние точки грубой.
+    struct RestrictWeights {
+        size_t first;
+        int count;
+        double w[4];
+    };
+
+    struct ProlongWeights {
+        size_t index;
+        double t;
+    };
+
+    struct Level {
+        size_t n = 0;
+        double h2 = 1.0;
+        double* u = nullptr;
+        std::vector<double> storage;
+        std::vector<double> f;
+        std::vector<double> r;
+        std::vector<double> tmp;
+        std::vector<RestrictWeights> restrict_w;
+        std::vector<ProlongWeights> prolong_w;
+    };
+
+    static void build_transfer(Level& fine, const Level& coarse)
+    {
+        const size_t mf = fine.n - 1;
+        const size_t mc = coarse.n - 1;
+        const double ratio = static_cast<double>(mf) / mc;
+
+        fine.restrict_w.resize(coarse.n);
+        for (size_t I = 1; I < mc; ++I)
+        {
+            RestrictWeights& rw = fine.restrict_w[I];
+            rw.count = 0;
+            const size_t lo = static_cast<size_t>(std::max(1.0, std::floor((I - 1) * ratio) + 1));
+            const size_t hi = std::min(mf - 1, static_cast<size_t>(std::ceil((I + 1) * ratio) - 1));
+            // Нулевые веса на краях окна (из-за округления) отбрасываются.
+            for (size_t i = lo; i <= hi && rw.count < 4; ++i)
+            {
+                const double w = 1.0 - std::fabs(i / ratio - I);
+                if (w <= 1e-12)
+                    continue;
+                if (rw.count == 0)
+                    rw.first = i;
+                rw.w[rw.count++] = w / ratio;
+            }
+        }
+
+        fine.prolong_w.resize(fine.n);
+        for (size_t i = 1; i < mf; ++i)
+        {
+            const double x = i / ratio;
+            const size_t I = std::min(static_cast<size_t>(x), mc - 1);
+            fine.prolong_w[i] = {I, x - I};
+        }
+    }
+
+    static const double* rhs(const Level& level)
+    {
+        return level.f.empty() ? nullptr : level.f.data();
+    }
+
+    void smooth(Level& level, int sweeps)
+    {
+        if (options_.smoother == Smoother::Jacobi)
+            smooth_jacobi(level, sweeps);
+        else
+            smooth_red_black(level, sweeps);
+    }
+
+    static void smooth_red_black(Level& level, int sweeps)
+    {
+        const size_t n = level.n;
+        double* u = level.u;
+        const double* f = rhs(level);
+        const double h2 = level.h2;
+
+        #pragma omp parallel
+        for (int s = 0; s < 2 * sweeps; ++s)
+        {
+            const int color = s & 1;
+            #pragma omp for
+            for (long i = 1; i < static_cast<long>(n) - 1; ++i)
+            {
+                double* row = u + i*n;
+                for (size_t j = 1 + ((i + 1 + color) & 1); j < n-1; j += 2)
+                {
+                    const double source = f ? h2 * f[i*n + j] : 0.0;
+                    row[j] = 0.25 * (row[j+n] + row[j-n] + row[j-1] + row[j+1] + source);
+                }
+            }
+        }
+    }
+
+    // Взвешенный Якоби с omega = 4/5 — оптимальное сглаживание для 2D.
+    static void smooth_jacobi(Level& level, int sweeps)
+    {
+        const double omega = 0.8;
+        const size_t n = level.n;
+        double* u = level.u;
+        double* tmp = level.tmp.data();
+        const double* f = rhs(level);
+        const double h2 = level.h2;
+
+        #pragma omp parallel
+        for (int s = 0; s < sweeps; ++s)
+        {
+            #pragma omp for
+            for (long i = 1; i < static_cast<long>(n) - 1; ++i)
+            {
+                for (size_t j = 1; j < n-1; ++j)
+                {
+                    const size_t k = i*n + j;
+                    const double source = f ? h2 * f[k] : 0.0;
+                    tmp[k] = (1.0 - omega) * u[k] + omega * 0.25 * (u[k+n] + u[k-n] + u[k-1] + u[k+1] + source);
+                }
+            }
+            #pragma omp for
+            for (long i = 1; i < static_cast<long>(n) - 1; ++i)
+                memcpy(u + i*n + 1, tmp + i*n + 1, (n - 2) * sizeof(double));
+        }
+    }
+
+    static void residual(Level& level)
+    {
+        const size_t n = level.n;
+        const double* u = level.u;
+        const double* f = rhs(level);
+        double* r = level.r.data();
+        const double inv_h2 = 1.0 / level.h2;
+
+        #pragma omp parallel for
+        for (long i = 1; i < static_cast<long>(n) - 1; ++i)
+        {
+            for (size_t j = 1; j < n-1; ++j)
+            {
+                const size_t k = i*n + j;
+                r[k] = (f ? f[k] : 0.0) - (4.0 * u[k] - u[k+n] - u[k-n] - u[k-1] - u[k+1]) * inv_h2;
+            }
+        }
+    }
+
+    // Невязка мелкой сетки -> правая часть грубой; поправка начинается с нуля.
+    static void restrict_residual(const Level& fine, Level& coarse)
+    {
+        const size_t nf = fine.n;
+        const size_t nc = coarse.n;
+        const double* r = fine.r.data();
+        double* f = coarse.f.data();
+
+        #pragma omp parallel for
+        for (long I = 1; I < static_cast<long>(nc) - 1; ++I)
+        {
+            const RestrictWeights& wi = fine.restrict_w[I];
+            for (size_t J = 1; J < nc-1; ++J)
+            {
+                const RestrictWeights& wj = fine.restrict_w[J];
+                double sum = 0.0;
+                for (int a = 0; a < wi.count; ++a)
+                {
+                    const double* row = r + (wi.first + a) * nf + wj.first;
+                    double row_sum = 0.0;
+                    for (int b = 0; b < wj.count; ++b)
+                        row_sum += wj.w[b] * row[b];
+                    sum += wi.w[a] * row_sum;
+                }
+                f[I*nc + J] = sum;
+            }
+        }
+        std::fill(coarse.storage.begin(), coarse.storage.end(), 0.0);
+    }
+
+    static void prolong_add(const Level& coarse, Level& fine)
+    {
+        const size_t nf = fine.n;
+        const size_t nc = coarse.n;
+        const double* e = coarse.u;
+        double* u = fine.u;
+
+        #pragma omp parallel for
+        for (long i = 1; i < static_cast<long>(nf) - 1; ++i)
+        {
+            const ProlongWeights& pi = fine.prolong_w[i];
+            const double* e0 = e + pi.index * nc;
+            const double* e1 = e0 + nc;
+            for (size_t j = 1; j < nf-1; ++j)
+            {
+                const ProlongWeights& pj = fine.prolong_w[j];
+                const size_t J = pj.index;
+                const double top = (1.0 - pj.t) * e0[J] + pj.t * e0[J+1];
+                const double bottom = (1.0 - pj.t) * e1[J] + pj.t * e1[J+1];
+                u[i*nf + j] += (1.0 - pi.t) * top + pi.t * bottom;
+            }
+        }
+    }
+
+    // На самой грубой сетке не больше 3x3 неизвестных: сглаживаем до сходимости.
+    void coarse_solve(Level& level)
+    {
+        smooth_red_black(level, 50);
+    }
+
+    void v_cycle(size_t l)
+    {
+        Level& level = levels_[l];
+        if (l + 1 == levels_.size())
+        {
+            coarse_solve(level);
+            return;
+        }
+        smooth(level, options_.pre_sweeps);
+        residual(level);
+        restrict_residual(level, levels_[l + 1]);
+        v_cycle(l + 1);
+        prolong_add(levels_[l + 1], level);
+        smooth(level, options_.post_sweeps);
+    }
+
+    // F-цикл: на грубом уровне сначала F-цикл, затем ещё один V-цикл.
+    void f_cycle(size_t l)
+    {
+        Level& level = levels_[l];
+        if (l + 1 == levels_.size())
+        {
+            coarse_solve(level);
+            return;
+        }
+        smooth(level, options_.pre_sweeps);
+        residual(level);
+        restrict_residual(level, levels_[l + 1]);
+        f_cycle(l + 1);
+        v_cycle(l + 1);
+        prolong_add(levels_[l + 1], level);
+        smooth(level, options_.post_sweeps);
+    }
+
+    MultigridOptions options_;
+    std::vector<Level> levels_;
+    std::vector<double> previous_;
+};
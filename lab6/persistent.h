@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "stencil_kernels.h"
+
+// Якоби в одной параллельной области на всё решение: буферы меняются
+// местами вместо copy_matrix, между проходами — только барьер omp for.
+// Общая редукция ошибки делается лишь на проверочных итерациях, как в
+// lab7 (раз в 1000 итераций): результат совпадает с solve_jacobi только
+// при проверке на каждой итерации, иначе решение останавливается на
+// первой проверке, где ошибка уже не больше accuracy.
+
+enum class CheckPolicy { Every, Fixed, Adaptive };
+
+struct CheckSchedule {
+    CheckPolicy policy = CheckPolicy::Every;
+    // Fixed: шаг проверок; Adaptive: наибольший шаг.
+    int interval = 100;
+};
+
+inline CheckSchedule parse_check_schedule(const std::string& name, int interval)
+{
+    CheckSchedule schedule;
+    schedule.interval = std::max(1, interval);
+    if (name == "fixed")
+        schedule.policy = CheckPolicy::Fixed;
+    else if (name == "adaptive")
+        schedule.policy = CheckPolicy::Adaptive;
+    return schedule;
+}
+
+// Следующая проверка после итерации iteration с ошибкой error. Adaptive
+// оценивает скорость сходимости по двум последним проверкам и ставит
+// проверку на полпути до прогнозируемого достижения точности. У самой
+// точности ошибка стоит на месте, немного растёт или падает на доли
+// процента, и прогноз по двум проверкам уходит в бесконечность: поэтому
+// шаг растёт не больше чем вдвое за проверку, а без уменьшения ошибки
+// остаётся прежним.
+inline int next_check(const CheckSchedule& schedule, int iteration, double error, int prev_iteration,
+                      double prev_error, double accuracy)
+{
+    if (schedule.policy == CheckPolicy::Every)
+        return iteration + 1;
+    if (schedule.policy == CheckPolicy::Fixed)
+        return iteration + schedule.interval;
+
+    if (prev_iteration <= 0)
+        return iteration + 1;
+    const int prev_step = iteration - prev_iteration;
+    int step = prev_step;
+    if (error > 0.0 && prev_error > error)
+    {
+        const double rate = std::log(error / prev_error) / (iteration - prev_iteration);
+        const double remaining = std::log(accuracy / error) / rate;
+        const double limit = std::min<double>(schedule.interval, 2.0 * prev_step);
+        step = static_cast<int>(std::min(limit, std::max(1.0, remaining / 2)));
+    }
+    return iteration + step;
+}
+
+SolveResult solve_jacobi_persistent(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                                    bool verbose, CheckSchedule schedule, RowKernel kernel)
+{
+    double error = accuracy + 1.0;
+    if (max_iterations <= 0)
+        return {0, error};
+
+    // Граница в обоих буферах одинакова: буферы меняются местами.
+    memcpy(Anew, A, size * size * sizeof(double));
+
+    double sweep_error = 0.0;
+    int iteration = 0;
+    int check_at = 1;
+    int prev_check = 0;
+    double prev_error = 0.0;
+    bool converged = false;
+    double* result = A;
+
+    #pragma omp parallel
+    {
+        // Указатели и счётчик у каждого потока свои и меняются одинаково,
+        // поэтому на обычной итерации нет ничего, кроме барьера цикла.
+        double* src = A;
+        double* dst = Anew;
+        int it = 0;
+        while (true)
+        {
+            const bool check = it + 1 == check_at || it + 1 == max_iterations;
+            if (check)
+            {
+                #pragma omp for schedule(static) reduction(max:sweep_error)
+                for (long i = 1; i < static_cast<long>(size) - 1; ++i)
+                    sweep_error = fmax(sweep_error, kernel(src, dst, size, i));
+            }
+            else
+            {
+                #pragma omp for schedule(static)
+                for (long i = 1; i < static_cast<long>(size) - 1; ++i)
+                    kernel(src, dst, size, i);
+            }
+            std::swap(src, dst);
+            it++;
+
+            if (check)
+            {
+                #pragma omp single
+                {
+                    error = sweep_error;
+                    sweep_error = 0.0;
+                    converged = !(error > accuracy);
+                    if (verbose && it % 10000 == 0)
+                    {
+                        std::cout << "Итерация: " << it << ", ошибка: " << error << "\n";
+                    }
+                    int next = next_check(schedule, it, error, prev_check, prev_error, accuracy);
+                    // Печать прогресса не пропускает кратные 10000 итерации.
+                    if (verbose)
+                        next = std::min(next, (it / 10000 + 1) * 10000);
+                    prev_check = it;
+                    prev_error = error;
+                    check_at = next;
+                    iteration = it;
+                    result = src;
+                }
+            }
+            if (converged || it >= max_iterations)
+                break;
+        }
+    }
+
+    if (result != A)
+        copy_matrix(A, result, size);
+    return {iteration, error};
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "grid.h"
+
+// Якоби с сеткой в типе T. Шаблон полностью пропускной: float вдвое
+// уменьшает байты на клетку. Acc — тип, в котором считаются изменение
+// клетки и максимум. Смешанный режим идёт во float, пока ошибка не
+// приблизится к разрешению float, затем продолжает в double до accuracy.
+
+enum class Precision { Double, Float, FloatDoubleError, Mixed };
+
+inline Precision parse_precision(const std::string& name)
+{
+    if (name == "double")
+        return Precision::Double;
+    if (name == "float")
+        return Precision::Float;
+    if (name == "float_double_error")
+        return Precision::FloatDoubleError;
+    if (name == "mixed")
+        return Precision::Mixed;
+    throw std::runtime_error("неизвестный тип сетки: " + name + " (double | float | float_double_error | mixed)");
+}
+
+inline const char* precision_name(Precision precision)
+{
+    switch (precision)
+    {
+    case Precision::Float: return "float";
+    case Precision::FloatDoubleError: return "float_double_error";
+    case Precision::Mixed: return "mixed";
+    default: return "double";
+    }
+}
+
+// omp simd разрешает векторизовать редукцию максимума без -ffast-math.
+template<typename T, typename Acc>
+inline Acc update_row_typed(const T* src, T* dst, size_t size, size_t i)
+{
+    const T* up = src + (i-1)*size;
+    const T* mid = src + i*size;
+    const T* down = src + (i+1)*size;
+    T* out = dst + i*size;
+    Acc error = 0;
+    #pragma omp simd reduction(max:error)
+    for (size_t j = 1; j < size-1; ++j)
+    {
+        const T value = T(0.25) * (down[j] + up[j] + mid[j-1] + mid[j+1]);
+        out[j] = value;
+        const Acc change = std::fabs(static_cast<Acc>(value) - static_cast<Acc>(mid[j]));
+        error = change > error ? change : error;
+    }
+    return error;
+}
+
+template<typename To, typename From>
+void convert_grid(const From* src, To* dst, size_t size)
+{
+    #pragma omp parallel for
+    for (long k = 0; k < static_cast<long>(size * size); ++k)
+        dst[k] = static_cast<To>(src[k]);
+}
+
+// Буферы меняются местами; итог — в A. first_iteration сдвигает нумерацию
+// для печати прогресса, когда решение продолжает предыдущую фазу.
+template<typename T, typename Acc>
+SolveResult solve_jacobi_typed(T* A, T* Anew, size_t size, double accuracy, int max_iterations, bool verbose,
+                               int first_iteration = 0)
+{
+    memcpy(Anew, A, size * size * sizeof(T));
+    T* src = A;
+    T* dst = Anew;
+
+    double error = accuracy + 1.0;
+    int iteration = 0;
+    while (error > accuracy && iteration < max_iterations)
+    {
+        Acc sweep_error = 0;
+        #pragma omp parallel for reduction(max:sweep_error)
+        for (long i = 1; i < static_cast<long>(size) - 1; ++i)
+            sweep_error = std::max(sweep_error, update_row_typed<T, Acc>(src, dst, size, i));
+        std::swap(src, dst);
+        error = sweep_error;
+        iteration++;
+
+        if (verbose && (first_iteration + iteration) % 10000 == 0)
+        {
+            std::cout << "Итерация: " << first_iteration + iteration << ", ошибка: " << error << "\n";
+        }
+    }
+
+    if (src != A)
+        memcpy(A, src, size * size * sizeof(T));
+    return {iteration, error};
+}
+
+// Порог перехода смешанного режима: изменение за проход в 16 ulp float
+// от наибольшего значения сетки (на границе) — дальше float в основном
+// шумит округлением.
+inline double mixed_switch_error(const double* A, size_t size)
+{
+    double largest = 0.0;
+    for (size_t k = 0; k < size * size; ++k)
+        largest = std::max(largest, std::fabs(A[k]));
+    return 16.0 * std::numeric_limits<float>::epsilon() * largest;
+}
+
+// Сетка на входе и результат — в double A, как у остальных методов.
+SolveResult solve_jacobi_precision(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                                   bool verbose, Precision precision)
+{
+    if (precision == Precision::Double)
+        return solve_jacobi_typed<double, double>(A, Anew, size, accuracy, max_iterations, verbose);
+
+    std::vector<float> F(size * size), Fnew(size * size);
+    convert_grid(A, F.data(), size);
+
+    SolveResult result;
+    if (precision == Precision::Float)
+        result = solve_jacobi_typed<float, float>(F.data(), Fnew.data(), size, accuracy, max_iterations, verbose);
+    else if (precision == Precision::FloatDoubleError)
+        result = solve_jacobi_typed<float, double>(F.data(), Fnew.data(), size, accuracy, max_iterations, verbose);
+    else
+    {
+        const double target = std::max(accuracy, mixed_switch_error(A, size));
+        result = solve_jacobi_typed<float, double>(F.data(), Fnew.data(), size, target, max_iterations, verbose);
+        if (result.error > accuracy && result.iterations < max_iterations)
+        {
+            convert_grid(F.data(), A, size);
+            SolveResult tail = solve_jacobi_typed<double, double>(A, Anew, size, accuracy,
+                                                                  max_iterations - result.iterations, verbose,
+                                                                  result.iterations);
+            return {result.iterations + tail.iterations, tail.error};
+        }
+    }
+    convert_grid(F.data(), A, size);
+    return result;
+}
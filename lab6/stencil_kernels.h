@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include "grid.h"
+
+// Ядро одной строки: шаг Якоби для строки i из src в dst и максимальное
+// изменение в строке. Векторные версии считают то же выражение в том же
+// порядке сложений, а максимум от порядка не зависит, поэтому результат
+// побитно совпадает со скалярным. Набор инструкций выбирается при запуске.
+
+using RowKernel = double (*)(const double* src, double* dst, size_t size, size_t i);
+
+enum class Isa { Scalar, Avx2, Avx512 };
+
+inline const char* isa_name(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Avx2: return "avx2";
+    case Isa::Avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+inline double update_row_scalar(const double* src, double* dst, size_t size, size_t i)
+{
+    const double* up = src + (i-1)*size;
+    const double* mid = src + i*size;
+    const double* down = src + (i+1)*size;
+    double* out = dst + i*size;
+    double error = 0.0;
+    for (size_t j = 1; j < size-1; ++j)
+    {
+        out[j] = 0.25 * (down[j] + up[j] + mid[j-1] + mid[j+1]);
+        error = fmax(error, fabs(out[j] - mid[j]));
+    }
+    return error;
+}
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+// Два независимых аккумулятора ошибки, чтобы цепочка max не ограничивала цикл.
+__attribute__((target("avx2")))
+inline double update_row_avx2(const double* src, double* dst, size_t size, size_t i)
+{
+    const double* up = src + (i-1)*size;
+    const double* mid = src + i*size;
+    const double* down = src + (i+1)*size;
+    double* out = dst + i*size;
+    const __m256d quarter = _mm256_set1_pd(0.25);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d err0 = _mm256_setzero_pd();
+    __m256d err1 = _mm256_setzero_pd();
+    size_t j = 1;
+    for (; j + 8 <= size - 1; j += 8)
+    {
+        __m256d v0 = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(
+            _mm256_loadu_pd(down + j), _mm256_loadu_pd(up + j)),
+            _mm256_loadu_pd(mid + j - 1)), _mm256_loadu_pd(mid + j + 1)), quarter);
+        __m256d v1 = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(
+            _mm256_loadu_pd(down + j + 4), _mm256_loadu_pd(up + j + 4)),
+            _mm256_loadu_pd(mid + j + 3)), _mm256_loadu_pd(mid + j + 5)), quarter);
+        _mm256_storeu_pd(out + j, v0);
+        _mm256_storeu_pd(out + j + 4, v1);
+        err0 = _mm256_max_pd(err0, _mm256_andnot_pd(sign, _mm256_sub_pd(v0, _mm256_loadu_pd(mid + j))));
+        err1 = _mm256_max_pd(err1, _mm256_andnot_pd(sign, _mm256_sub_pd(v1, _mm256_loadu_pd(mid + j + 4))));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_max_pd(err0, err1));
+    double error = fmax(fmax(lanes[0], lanes[1]), fmax(lanes[2], lanes[3]));
+    for (; j < size-1; ++j)
+    {
+        out[j] = 0.25 * (down[j] + up[j] + mid[j-1] + mid[j+1]);
+        error = fmax(error, fabs(out[j] - mid[j]));
+    }
+    return error;
+}
+
+// Формы с маской: у GCC 12 _mm512_max_pd и _mm512_reduce_max_pd дают
+// ложное -Wuninitialized из-за _mm512_undefined_pd внутри.
+__attribute__((target("avx512f")))
+inline double update_row_avx512(const double* src, double* dst, size_t size, size_t i)
+{
+    const double* up = src + (i-1)*size;
+    const double* mid = src + i*size;
+    const double* down = src + (i+1)*size;
+    double* out = dst + i*size;
+    const __m512d quarter = _mm512_set1_pd(0.25);
+    __m512d err0 = _mm512_setzero_pd();
+    __m512d err1 = _mm512_setzero_pd();
+    size_t j = 1;
+    for (; j + 16 <= size - 1; j += 16)
+    {
+        __m512d v0 = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_add_pd(
+            _mm512_loadu_pd(down + j), _mm512_loadu_pd(up + j)),
+            _mm512_loadu_pd(mid + j - 1)), _mm512_loadu_pd(mid + j + 1)), quarter);
+        __m512d v1 = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_add_pd(
+            _mm512_loadu_pd(down + j + 8), _mm512_loadu_pd(up + j + 8)),
+            _mm512_loadu_pd(mid + j + 7)), _mm512_loadu_pd(mid + j + 9)), quarter);
+        _mm512_storeu_pd(out + j, v0);
+        _mm512_storeu_pd(out + j + 8, v1);
+        err0 = _mm512_mask_max_pd(err0, 0xFF, err0, _mm512_abs_pd(_mm512_sub_pd(v0, _mm512_loadu_pd(mid + j))));
+        err1 = _mm512_mask_max_pd(err1, 0xFF, err1, _mm512_abs_pd(_mm512_sub_pd(v1, _mm512_loadu_pd(mid + j + 8))));
+    }
+    double lanes[16];
+    _mm512_storeu_pd(lanes, err0);
+    _mm512_storeu_pd(lanes + 8, err1);
+    double error = 0.0;
+    for (double lane : lanes)
+        error = fmax(error, lane);
+    for (; j < size-1; ++j)
+    {
+        out[j] = 0.25 * (down[j] + up[j] + mid[j-1] + mid[j+1]);
+        error = fmax(error, fabs(out[j] - mid[j]));
+    }
+    return error;
+}
+#endif
+
+inline bool isa_supported(Isa isa)
+{
+#if defined(__x86_64__)
+    if (isa == Isa::Avx2)
+        return __builtin_cpu_supports("avx2");
+    if (isa == Isa::Avx512)
+        return __builtin_cpu_supports("avx512f");
+#endif
+    return isa == Isa::Scalar;
+}
+
+// AVX2 предпочтительнее: невыровненные 64-байтные загрузки соседних
+// столбцов чаще пересекают строку кэша, и до 1024x1024 AVX-512 медленнее
+// (см. bench --mode=isa). AVX-512 выбирается только явно.
+inline Isa best_isa()
+{
+    static const Isa best = isa_supported(Isa::Avx2) ? Isa::Avx2
+                          : isa_supported(Isa::Avx512) ? Isa::Avx512 : Isa::Scalar;
+    return best;
+}
+
+// "auto" — лучший доступный; набор, который процессор не поддерживает,
+// заменяется скалярным. Неизвестное имя — ошибка.
+inline Isa parse_isa(const std::string& name)
+{
+    Isa isa;
+    if (name == "auto")
+        isa = best_isa();
+    else if (name == "scalar")
+        isa = Isa::Scalar;
+    else if (name == "avx2")
+        isa = Isa::Avx2;
+    else if (name == "avx512")
+        isa = Isa::Avx512;
+    else
+        throw std::runtime_error("неизвестный набор инструкций: " + name + " (auto | scalar | avx2 | avx512)");
+    return isa_supported(isa) ? isa : Isa::Scalar;
+}
+
+inline RowKernel row_kernel(Isa isa)
+{
+#if defined(__x86_64__)
+    if (isa == Isa::Avx512)
+        return update_row_avx512;
+    if (isa == Isa::Avx2)
+        return update_row_avx2;
+#endif
+    return update_row_scalar;
+}
+
+double calculate_next_grid(double* A, double* Anew, size_t size, RowKernel kernel)
+{
+    double error = 0.0;
+
+    #pragma omp parallel for reduction(max:error)
+    for (long i = 1; i < static_cast<long>(size) - 1; ++i)
+        error = fmax(error, kernel(A, Anew, size, i));
+
+    return error;
+}
+
+SolveResult solve_jacobi(double* A, double* Anew, size_t size, double accuracy, int max_iterations, bool verbose,
+                         RowKernel kernel)
+{
+    return jacobi_loop(A, Anew, size, accuracy, max_iterations, verbose,
+                       [kernel](double* a, double* anew, size_t n) { return calculate_next_grid(a, anew, n, kernel); });
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "stencil_kernels.h"
+
+// Временная блокировка Якоби: полосы строк проходят несколько шагов подряд,
+// пока полоса лежит в кэше, вместо одного прохода по всей сетке на шаг.
+//
+// Блок из T шагов делается в две фазы (ромбы в координатах строка-время):
+//  1. каждая полоса считает шаг s на строках, сужающихся на одну строку
+//     с каждой внутренней стороны, — полосы независимы;
+//  2. треугольники вокруг границ полос досчитывают оставшиеся строки.
+// Каждая пара (строка, шаг) вычисляется ровно один раз тем же ядром строки
+// из stencil_kernels.h, поэтому результат совпадает побитно.
+// Двух буферов хватает: строка шага s+1 затирает шаг s-1 только там, где
+// он уже никому не нужен.
+
+struct TemporalBlocking {
+    int time_steps;
+    size_t band_rows;
+};
+
+// Полоса из двух буферов должна помещаться примерно в L2.
+TemporalBlocking choose_blocking(size_t size, int time_steps)
+{
+    const size_t cache_bytes = 1 << 20;
+    const size_t interior = size - 2;
+    size_t band = std::max<size_t>(8, cache_bytes / (2 * size * sizeof(double)));
+    if (time_steps <= 0)
+        time_steps = static_cast<int>(std::min<size_t>(32, band / 2));
+    band = std::max(band, 2 * static_cast<size_t>(time_steps));
+    // Полос должно хватить на все потоки, пока это не ломает условие band >= 2T.
+    const size_t threads = omp_get_max_threads();
+    if (interior / band < threads)
+        band = std::max(2 * static_cast<size_t>(time_steps), interior / threads);
+    return {time_steps, std::min(band, interior)};
+}
+
+// T шагов из bufs[0] (шаг 0); шаг s пишется в bufs[s & 1]. errors[s-1] —
+// ошибка шага s. Внутренние строки шага 0 попутно сохраняются в snapshot.
+void advance_block(double* bufs[2], size_t size, int T, size_t band, double* errors, double* snapshot,
+                   RowKernel kernel)
+{
+    const size_t interior = size - 2;
+    const size_t bands = std::max<size_t>(1, interior / band);
+    const long nbands = static_cast<long>(bands);
+    std::fill(errors, errors + T, 0.0);
+
+    #pragma omp parallel for schedule(static) reduction(max:errors[:T])
+    for (long b = 0; b < nbands; ++b)
+    {
+        const size_t start = 1 + b * band;
+        const size_t end = (b == nbands - 1) ? size - 1 : start + band;
+        memcpy(snapshot + start*size, bufs[0] + start*size, (end - start) * size * sizeof(double));
+        for (int s = 1; s <= T; ++s)
+        {
+            const size_t lo = (b == 0) ? 1 : start + (s - 1);
+            const size_t hi = (b == nbands - 1) ? size - 1 : end - (s - 1);
+            double error = 0.0;
+            for (size_t i = lo; i < hi; ++i)
+                error = fmax(error, kernel(bufs[(s-1) & 1], bufs[s & 1], size, i));
+            errors[s-1] = fmax(errors[s-1], error);
+        }
+    }
+
+    #pragma omp parallel for schedule(static) reduction(max:errors[:T])
+    for (long b = 1; b < nbands; ++b)
+    {
+        const size_t p = 1 + b * band;
+        for (int s = 2; s <= T; ++s)
+        {
+            double error = 0.0;
+            for (size_t i = p - (s - 1); i < p + (s - 1); ++i)
+                error = fmax(error, kernel(bufs[(s-1) & 1], bufs[s & 1], size, i));
+            errors[s-1] = fmax(errors[s-1], error);
+        }
+    }
+}
+
+// Тот же контракт, что у solve_jacobi: итерации, ошибки и итоговая сетка
+// в A совпадают. Если точность достигнута внутри блока, сетка
+// восстанавливается из снимка и нужные шаги повторяются по одному.
+SolveResult solve_jacobi_tiled(double* A, double* Anew, size_t size, double accuracy, int max_iterations,
+                               bool verbose, int time_steps = 0, RowKernel kernel = update_row_scalar)
+{
+    const TemporalBlocking blocking = choose_blocking(size, time_steps);
+    std::vector<double> errors(blocking.time_steps);
+    std::vector<double> snapshot(size * size);
+
+    // Граница в обоих буферах одинакова: буферы меняются местами.
+    memcpy(Anew, A, size * size * sizeof(double));
+    double* bufs[2] = {A, Anew};
+
+    double error = accuracy + 1.0;
+    int iteration = 0;
+    while (error > accuracy && iteration < max_iterations)
+    {
+        const int T = std::min(blocking.time_steps, max_iterations - iteration);
+        advance_block(bufs, size, T, blocking.band_rows, errors.data(), snapshot.data(), kernel);
+
+        int done = T;
+        for (int s = 0; s < T; ++s)
+        {
+            if (!(errors[s] > accuracy))
+            {
+                done = s + 1;
+                break;
+            }
+        }
+
+        if (done < T)
+        {
+            memcpy(bufs[0] + size, snapshot.data() + size, (size - 2) * size * sizeof(double));
+            for (int s = 1; s <= done; ++s)
+            {
+                #pragma omp parallel for
+                for (long i = 1; i < static_cast<long>(size) - 1; ++i)
+                    kernel(bufs[(s-1) & 1], bufs[s & 1], size, i);
+            }
+        }
+        if (done & 1)
+            std::swap(bufs[0], bufs[1]);
+
+        for (int s = 0; s < done; ++s)
+        {
+            if (verbose && (iteration + s + 1) % 10000 == 0)
+            {
+                std::cout << "Итерация: " << iteration + s + 1 << ", ошибка: " << errors[s] << "\n";
+            }
+        }
+        iteration += done;
+        error = errors[done - 1];
+    }
+
+    if (bufs[0] != A)
+        copy_matrix(A, bufs[0], size);
+    return {iteration, error};
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+// Всё, что в task.cpp завязано на CUDA: буфер разностей на устройстве,
+// поиск максимума через cublasIdamax и разметка NVTX. С pgc++ -acc
+// (определён _OPENACC) — исходная реализация, иначе — CPU-замены, и тот
+// же task.cpp собирается g++/clang++ с -fopenmp: директивы acc там
+// игнорируются, циклы распараллеливают соседние директивы omp.
+
+#if defined(_OPENACC)
+
+#include <cuda_runtime.h>
+#include <cublas_v2.h>
+#include <nvtx3/nvToolsExt.h>
+
+inline const char* backend_name()
+{
+    return "GPU версия с cuBLAS";
+}
+
+class Blas {
+public:
+    Blas() { cublasCreate(&handle_); }
+    ~Blas() { cublasDestroy(handle_); }
+    Blas(const Blas&) = delete;
+    Blas& operator=(const Blas&) = delete;
+
+    // Максимум неотрицательного массива diff, лежащего на устройстве.
+    double max_value(double* diff, int n)
+    {
+        int index = 0;
+        double value = 0.0;
+        #pragma acc host_data use_device(diff)
+        {
+            cublasIdamax(handle_, n, diff, 1, &index);
+            cudaMemcpy(&value, &diff[index-1], sizeof(double), cudaMemcpyDeviceToHost);
+        }
+        return value;
+    }
+
+private:
+    cublasHandle_t handle_;
+};
+
+inline double* allocate_diff(int n)
+{
+    double* diff = nullptr;
+    cudaMalloc((void**)&diff, sizeof(double) * n);
+    return diff;
+}
+
+inline void free_diff(double* diff)
+{
+    cudaFree(diff);
+}
+
+inline void range_push(const char* name)
+{
+    nvtxRangePushA(name);
+}
+
+inline void range_pop()
+{
+    nvtxRangePop();
+}
+
+#else
+
+#include <omp.h>
+
+inline const char* backend_name()
+{
+    return "CPU версия, OpenMP";
+}
+
+// cublasIdamax на CPU — редукция максимума; diff уже содержит модули.
+class Blas {
+public:
+    double max_value(double* diff, int n)
+    {
+        double value = 0.0;
+        #pragma omp parallel for simd reduction(max:value)
+        for (int k = 0; k < n; ++k)
+            value = diff[k] > value ? diff[k] : value;
+        return value;
+    }
+};
+
+inline double* allocate_diff(int n)
+{
+    return (double*)malloc(sizeof(double) * n);
+}
+
+inline void free_diff(double* diff)
+{
+    free(diff);
+}
+
+inline void range_push(const char*) {}
+inline void range_pop() {}
+
+#endif
@@ -4,9 +4,8 @@
 #include <iomanip>
 #include <memory>
 #include <fstream>
-#include <cublas_v2.h>
-#include <nvtx3/nvToolsExt.h>
 #include <boost/program_options.hpp>
+#include "backend.h"
 
 namespace po = boost::program_options;
 
@@ -35,8 +34,10 @@ void initialize(double* A, double* Anew, size_t size) {
 
 void calculate_grid(double* A, double* Anew, size_t size) {
     #pragma acc parallel loop present(A, Anew)
+    #pragma omp parallel for
     for (int i = 1; i < size-1; ++i) {
         #pragma acc loop
+        #pragma omp simd
         for (int j = 1; j < size-1; ++j) {
             Anew[i*size + j] = 0.25 * (A[(i+1)*size + j] + A[(i-1)*size + j] + 
                                        A[i*size + j-1] + A[i*size + j+1]);
@@ -46,8 +47,10 @@ void calculate_grid(double* A, double* Anew, size_t size) {
 
 void calculate_diff(double* A, double* Anew, double* diff, size_t size) {
     #pragma acc parallel loop present(A, Anew, diff)
+    #pragma omp parallel for
     for (int i = 1; i < size-1; i++) {
         #pragma acc loop
+        #pragma omp simd
         for (int j = 1; j < size-1; j++) {
             diff[(i-1) * (size-2) + (j-1)] = fabs(A[i * size + j] - Anew[i * size + j]);
         }
@@ -56,8 +59,10 @@ void calculate_diff(double* A, double* Anew, double* diff, size_t size) {
 
 void copy_matrix(double* A, double* Anew, size_t size) {
     #pragma acc parallel loop present(A, Anew)
+    #pragma omp parallel for
     for (int i = 1; i < size-1; i++) {
         #pragma acc loop
+        #pragma omp simd
         for (int j = 1; j < size-1; j++) {
             A[i * size + j] = Anew[i * size + j];
         }
@@ -68,7 +73,7 @@ void deallocate(double* A, double* Anew, double* diff, size_t size) {
     #pragma acc exit data delete(A[:size*size], Anew[:size*size], diff[:(size-2)*(size-2)])
     free(A);
     free(Anew);
-    cudaFree(diff);
+    free_diff(diff);
 }
 
 void print_grid(double* A, size_t size) {
@@ -99,7 +104,7 @@ int main(int argc, char* argv[]) {
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
     
-    std::cout << "Запуск программы (GPU версия с cuBLAS)!\n";
+    std::cout << "Запуск программы (" << backend_name() << ")!\n";
     std::cout << "Размер сетки: " << size << "x" << size << "\n";
     std::cout << "Точность: " << accuracy << "\n";
     std::cout << "Максимальное количество итераций: " << max_iterations << "\n\n";
@@ -109,57 +114,43 @@ int main(int argc, char* argv[]) {
     
     double* diff;
     int diff_size = (size-2) * (size-2);
-    cudaMalloc((void**)&diff, sizeof(double) * diff_size);
+    diff = allocate_diff(diff_size);
 
     double error = accuracy + 1.0;
     int iteration = 0;
-    int max_error_index = 0;
+    Blas blas;
     
-    auto cublas_deleter = [](cublasHandle_t* handle) {
-        if (handle && *handle) {
-            cublasDestroy(*handle);
-            delete handle;
-        }
-    };
-    std::unique_ptr<cublasHandle_t, decltype(cublas_deleter)> handle(new cublasHandle_t, cublas_deleter);
-    cublasCreate(handle.get());
-    
-    nvtxRangePushA("Initialization");
+    range_push("Initialization");
     initialize(A, Anew, size);
     #pragma acc enter data copyin(A[:size*size], Anew[:size*size]) create(diff[:diff_size])
-    nvtxRangePop();
+    range_pop();
     
     const auto start{std::chrono::steady_clock::now()};
     
-    nvtxRangePushA("Main loop");
+    range_push("Main loop");
     while (error > accuracy && iteration < max_iterations) {
-        nvtxRangePushA("Calculate grid");
+        range_push("Calculate grid");
         calculate_grid(A, Anew, size);
-        nvtxRangePop();
+        range_pop();
         
         if (iteration % 1000 == 0) {
-            nvtxRangePushA("Error calculation");
+            range_push("Error calculation");
             calculate_diff(A, Anew, diff, size);
-            
-            #pragma acc host_data use_device(diff)
-            {
-                cublasIdamax(*handle, diff_size, diff, 1, &max_error_index);
-                cudaMemcpy(&error, &diff[max_error_index-1], sizeof(double), cudaMemcpyDeviceToHost);
-            }
-            nvtxRangePop();
+            error = blas.max_value(diff, diff_size);
+            range_pop();
             
             if (iteration % 10000 == 0) {
                 std::cout << "Итерация: " << iteration << ", ошибка: " << error << "\n";
             }
         }
         
-        nvtxRangePushA("Copy matrix");
+        range_push("Copy matrix");
         copy_matrix(A, Anew, size);
-        nvtxRangePop();
+        range_pop();
         
         iteration++;
     }
-    nvtxRangePop();
+    range_pop();
     
     const auto end{std::chrono::steady_clock::now()};
     const std::chrono::duration<double> elapsed_seconds{end - start};
@@ -168,6 +159,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Время выполнения: " << elapsed_seconds.count() << " секунд\n";
     std::cout << "Количество итераций: " << iteration << "\n";
     std::cout << "Конечная ошибка: " << error << "\n";
+    std::cout << "Скорость: " << static_cast<double>(size - 2) * (size - 2) * iteration / elapsed_seconds.count() / 1e6
+              << " MLUP/s\n";
     
     if (size == 10 || size == 13) {
         print_grid(A, size);
@@ -181,7 +174,7 @@ int main(int argc, char* argv[]) {
             
             A = (double*)malloc(size * size * sizeof(double));
             Anew = (double*)malloc(size * size * sizeof(double));
-            cudaMalloc((void**)&diff, sizeof(double) * diff_size);
+            diff = allocate_diff(diff_size);
             
             initialize(A, Anew, size);
             #pragma acc enter data copyin(A[:size*size], Anew[:size*size]) create(diff[:diff_size])
@@ -192,12 +185,7 @@ int main(int argc, char* argv[]) {
             while (error > accuracy && iteration < max_iterations) {
                 calculate_grid(A, Anew, size);
                 calculate_diff(A, Anew, diff, size);
-                
-                #pragma acc host_data use_device(diff)
-                {
-                    cublasIdamax(*handle, diff_size, diff, 1, &max_error_index);
-                    cudaMemcpy(&error, &diff[max_error_index-1], sizeof(double), cudaMemcpyDeviceToHost);
-                }
+                error = blas.max_value(diff, diff_size);
                 
                 copy_matrix(A, Anew, size);
                 iteration++;